@@ -15,6 +15,7 @@ BUILD_OPTION_NAMES = \
 
 HARDWARE_OPTION_NAMES = \
   SLEEP_LED_ENABLE \
+  MATRIX_IDLE_SLEEP_ENABLE \
   BACKLIGHT_ENABLE \
   BACKLIGHT_DRIVER \
   RGBLIGHT_ENABLE \
@@ -28,6 +29,7 @@ HARDWARE_OPTION_NAMES = \
   AUDIO_ENABLE \
   HD44780_ENABLE \
   ENCODER_ENABLE \
+  ENCODER_INTERRUPT_ENABLE \
   LED_TABLES \
   POINTING_DEVICE_ENABLE \
   DIP_SWITCH_ENABLE
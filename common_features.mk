@@ -39,6 +39,11 @@ else
     include $(PLATFORM_PATH)/$(PLATFORM_KEY)/printf.mk
 endif
 
+ifeq ($(strip $(LATENCY_PROFILE_ENABLE)), yes)
+    SRC += $(QUANTUM_DIR)/latency_profile.c
+    OPT_DEFS += -DLATENCY_PROFILE_ENABLE
+endif
+
 ifeq ($(strip $(DEBUG_MATRIX_SCAN_RATE_ENABLE)), yes)
     OPT_DEFS += -DDEBUG_MATRIX_SCAN_RATE
     CONSOLE_ENABLE = yes
@@ -392,6 +397,26 @@ ifeq ($(strip $(SLEEP_LED_ENABLE)), yes)
     NO_SUSPEND_POWER_DOWN := yes
 endif
 
+ifeq ($(strip $(MATRIX_IDLE_SLEEP_ENABLE)), yes)
+    ifneq ($(filter yes lite,$(strip $(CUSTOM_MATRIX))),)
+        $(error MATRIX_IDLE_SLEEP_ENABLE is not supported with CUSTOM_MATRIX)
+    endif
+    SRC += $(PLATFORM_COMMON_DIR)/pin_wakeup.c
+    OPT_DEFS += -DMATRIX_IDLE_SLEEP_ENABLE
+    PIN_INTERRUPT_REQUIRED := yes
+endif
+
+ifeq ($(strip $(ENCODER_ENABLE)), yes)
+    ifeq ($(strip $(ENCODER_INTERRUPT_ENABLE)), yes)
+        OPT_DEFS += -DENCODER_INTERRUPT_ENABLE
+        PIN_INTERRUPT_REQUIRED := yes
+    endif
+endif
+
+ifeq ($(strip $(PIN_INTERRUPT_REQUIRED)), yes)
+    SRC += $(PLATFORM_COMMON_DIR)/pin_interrupt.c
+endif
+
 VALID_BACKLIGHT_TYPES := pwm timer software custom
 
 BACKLIGHT_ENABLE ?= no
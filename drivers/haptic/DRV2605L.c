@@ -26,7 +26,12 @@ uint8_t DRV2605L_read_register;
 void DRV_write(uint8_t drv_register, uint8_t settings) {
     DRV2605L_transfer_buffer[0] = drv_register;
     DRV2605L_transfer_buffer[1] = settings;
+#ifdef I2C_ASYNC_ENABLE
+    // Register writes don't need to hold up the caller, reads still wait for them to complete first
+    i2c_transmit_async(DRV2605L_BASE_ADDRESS << 1, DRV2605L_transfer_buffer, 2, 100, NULL, NULL);
+#else
     i2c_transmit(DRV2605L_BASE_ADDRESS << 1, DRV2605L_transfer_buffer, 2, 100);
+#endif
 }
 
 uint8_t DRV_read(uint8_t regaddress) {
@@ -57,6 +57,18 @@
 #    define ISSI_PERSISTENCE 0
 #endif
 
+// With I2C_ASYNC_ENABLE writes are queued and the transfer buffer is copied,
+// so a frame update returns without waiting for the bus. A PWM span that fails
+// to write is picked up again by the next update. Retrying with
+// ISSI_PERSISTENCE needs the result of every write, so that stays blocking.
+#if defined(I2C_ASYNC_ENABLE) && ISSI_PERSISTENCE == 0
+#    define ISSI_ASYNC
+#    include "atomic_util.h"
+#    define ISSI_TRANSMIT(addr, data, length) i2c_transmit_async(addr, data, length, ISSI_TIMEOUT, NULL, NULL)
+#else
+#    define ISSI_TRANSMIT(addr, data, length) i2c_transmit(addr, data, length, ISSI_TIMEOUT)
+#endif
+
 // Transfer buffer for TWITransmitData()
 uint8_t g_twi_transfer_buffer[20];
 
@@ -65,8 +77,10 @@ uint8_t g_twi_transfer_buffer[20];
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in IS31FL3731_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][144];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+// Bit n of g_pwm_buffer_dirty is set when the 16 bytes starting at
+// g_pwm_buffer[n * 16] have changed since they were last written.
+uint8_t  g_pwm_buffer[DRIVER_COUNT][144];
+uint16_t g_pwm_buffer_dirty[DRIVER_COUNT] = {0};
 
 uint8_t g_led_control_registers[DRIVER_COUNT][18]             = {{0}};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
@@ -91,37 +105,67 @@ void IS31FL3731_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 
 #if ISSI_PERSISTENCE > 0
     for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0) break;
+        if (ISSI_TRANSMIT(addr << 1, g_twi_transfer_buffer, 2) == 0) break;
     }
 #else
-    i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT);
+    ISSI_TRANSMIT(addr << 1, g_twi_transfer_buffer, 2);
 #endif
 }
 
-void IS31FL3731_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
-    // assumes bank is already selected
-
-    // transmit PWM registers in 9 transfers of 16 bytes
+static void IS31FL3731_fill_pwm_span(uint8_t *pwm_buffer, uint8_t span) {
     // g_twi_transfer_buffer[] is 20 bytes
 
-    // iterate over the pwm_buffer contents at 16 byte intervals
-    for (int i = 0; i < 144; i += 16) {
-        // set the first register, e.g. 0x24, 0x34, 0x44, etc.
-        g_twi_transfer_buffer[0] = 0x24 + i;
-        // copy the data from i to i+15
-        // device will auto-increment register for data after the first byte
-        // thus this sets registers 0x24-0x33, 0x34-0x43, etc. in one transfer
-        for (int j = 0; j < 16; j++) {
-            g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
-        }
+    // set the first register, e.g. 0x24, 0x34, 0x44, etc.
+    g_twi_transfer_buffer[0] = 0x24 + span * 16;
+    // copy the data from span*16 to span*16+15
+    // device will auto-increment register for data after the first byte
+    for (int j = 0; j < 16; j++) {
+        g_twi_transfer_buffer[1 + j] = pwm_buffer[span * 16 + j];
+    }
+}
+
+static bool IS31FL3731_write_pwm_span(uint8_t addr, uint8_t *pwm_buffer, uint8_t span) {
+    // assumes bank is already selected
+    // returns false if the write failed
+    IS31FL3731_fill_pwm_span(pwm_buffer, span);
 
 #if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
-        }
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) return true;
+    }
+    return false;
 #else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
+    return i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0;
 #endif
+}
+
+#ifdef ISSI_ASYNC
+// Bit n of g_pwm_buffer_failed is set from the I2C thread when a queued
+// write of span n has failed, until the next update marks it dirty again.
+static volatile uint16_t g_pwm_buffer_failed[DRIVER_COUNT] = {0};
+
+static void IS31FL3731_queued_pwm_span_done(i2c_status_t status, void *arg) {
+    if (status != I2C_STATUS_SUCCESS) {
+        uint8_t index = (uintptr_t)arg / 9;
+        uint8_t span  = (uintptr_t)arg % 9;
+        ATOMIC_BLOCK_FORCEON { g_pwm_buffer_failed[index] |= 1 << span; }
+    }
+}
+
+static bool IS31FL3731_queue_pwm_span(uint8_t addr, uint8_t index, uint8_t span) {
+    // assumes bank is already selected
+    // returns false if the write could not be queued
+    IS31FL3731_fill_pwm_span(g_pwm_buffer[index], span);
+    return i2c_transmit_async(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT, IS31FL3731_queued_pwm_span_done, (void *)(uintptr_t)(index * 9 + span)) == I2C_STATUS_SUCCESS;
+}
+#endif
+
+void IS31FL3731_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    // assumes bank is already selected
+
+    // transmit PWM registers in 9 transfers of 16 bytes
+    for (uint8_t span = 0; span < 9; span++) {
+        IS31FL3731_write_pwm_span(addr, pwm_buffer, span);
     }
 }
 
@@ -180,16 +224,24 @@ void IS31FL3731_init(uint8_t addr) {
     IS31FL3731_write_register(addr, ISSI_COMMANDREGISTER, 0);
 }
 
+static inline void IS31FL3731_set_pwm(uint8_t driver, uint8_t reg, uint8_t value) {
+    // only mark the span dirty if the value actually changes, so frames
+    // which repaint the same colors do not cause any I2C traffic
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_dirty[driver] |= 1 << (reg / 16);
+    }
+}
+
 void IS31FL3731_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     is31_led led;
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         memcpy_P(&led, (&g_is31_leds[index]), sizeof(led));
 
         // Subtract 0x24 to get the second index of g_pwm_buffer
-        g_pwm_buffer[led.driver][led.r - 0x24]   = red;
-        g_pwm_buffer[led.driver][led.g - 0x24]   = green;
-        g_pwm_buffer[led.driver][led.b - 0x24]   = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3731_set_pwm(led.driver, led.r - 0x24, red);
+        IS31FL3731_set_pwm(led.driver, led.g - 0x24, green);
+        IS31FL3731_set_pwm(led.driver, led.b - 0x24, blue);
     }
 }
 
@@ -230,10 +282,29 @@ void IS31FL3731_set_led_control_register(uint8_t index, bool red, bool green, bo
 }
 
 void IS31FL3731_update_pwm_buffers(uint8_t addr, uint8_t index) {
-    if (g_pwm_buffer_update_required[index]) {
-        IS31FL3731_write_pwm_buffer(addr, g_pwm_buffer[index]);
+#ifdef ISSI_ASYNC
+    // queued spans that failed to write since the last update are written again
+    uint16_t failed;
+    ATOMIC_BLOCK_FORCEON {
+        failed                     = g_pwm_buffer_failed[index];
+        g_pwm_buffer_failed[index] = 0;
+    }
+    g_pwm_buffer_dirty[index] |= failed;
+#endif
+    // only write the spans which changed since the last update,
+    // spans that fail to write stay dirty so they are retried next time
+    for (uint8_t span = 0; span < 9; span++) {
+        if (g_pwm_buffer_dirty[index] & (1 << span)) {
+#ifdef ISSI_ASYNC
+            bool written = IS31FL3731_queue_pwm_span(addr, index, span);
+#else
+            bool written = IS31FL3731_write_pwm_span(addr, g_pwm_buffer[index], span);
+#endif
+            if (written) {
+                g_pwm_buffer_dirty[index] &= ~(1 << span);
+            }
+        }
     }
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void IS31FL3731_update_led_control_registers(uint8_t addr, uint8_t index) {
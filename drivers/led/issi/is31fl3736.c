@@ -55,6 +55,18 @@
 #    define ISSI_PERSISTENCE 0
 #endif
 
+// With I2C_ASYNC_ENABLE writes are queued and the transfer buffer is copied,
+// so a frame update returns without waiting for the bus. A PWM span that fails
+// to write is picked up again by the next update. Retrying with
+// ISSI_PERSISTENCE needs the result of every write, so that stays blocking.
+#if defined(I2C_ASYNC_ENABLE) && ISSI_PERSISTENCE == 0
+#    define ISSI_ASYNC
+#    include "atomic_util.h"
+#    define ISSI_TRANSMIT(addr, data, length) i2c_transmit_async(addr, data, length, ISSI_TIMEOUT, NULL, NULL)
+#else
+#    define ISSI_TRANSMIT(addr, data, length) i2c_transmit(addr, data, length, ISSI_TIMEOUT)
+#endif
+
 #ifndef ISSI_SWPULLUP
 #    define ISSI_SWPULLUP PUR_0R
 #endif
@@ -72,8 +84,10 @@ uint8_t g_twi_transfer_buffer[20];
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in IS31FL3736_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][192];
-bool    g_pwm_buffer_update_required = false;
+// Bit n of g_pwm_buffer_dirty is set when registers 16*n to 16*n+15
+// have changed since they were last written.
+uint8_t  g_pwm_buffer[DRIVER_COUNT][192];
+uint16_t g_pwm_buffer_dirty = 0;
 
 uint8_t g_led_control_registers[DRIVER_COUNT][24] = {{0}, {0}};
 bool    g_led_control_registers_update_required   = false;
@@ -84,36 +98,66 @@ void IS31FL3736_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 
 #if ISSI_PERSISTENCE > 0
     for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0) break;
+        if (ISSI_TRANSMIT(addr << 1, g_twi_transfer_buffer, 2) == 0) break;
     }
 #else
-    i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT);
+    ISSI_TRANSMIT(addr << 1, g_twi_transfer_buffer, 2);
 #endif
 }
 
-void IS31FL3736_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
-    // assumes PG1 is already selected
-
-    // transmit PWM registers in 12 transfers of 16 bytes
+static void IS31FL3736_fill_pwm_span(uint8_t *pwm_buffer, uint8_t span) {
     // g_twi_transfer_buffer[] is 20 bytes
 
-    // iterate over the pwm_buffer contents at 16 byte intervals
-    for (int i = 0; i < 192; i += 16) {
-        g_twi_transfer_buffer[0] = i;
-        // copy the data from i to i+15
-        // device will auto-increment register for data after the first byte
-        // thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer
-        for (int j = 0; j < 16; j++) {
-            g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
-        }
+    // set the first register, e.g. 0x00, 0x10, 0x20, etc.
+    g_twi_transfer_buffer[0] = span * 16;
+    // copy the data from span*16 to span*16+15
+    // device will auto-increment register for data after the first byte
+    for (int j = 0; j < 16; j++) {
+        g_twi_transfer_buffer[1 + j] = pwm_buffer[span * 16 + j];
+    }
+}
+
+static bool IS31FL3736_write_pwm_span(uint8_t addr, uint8_t *pwm_buffer, uint8_t span) {
+    // assumes PG1 is already selected
+    // returns false if the write failed
+    IS31FL3736_fill_pwm_span(pwm_buffer, span);
 
 #if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
-        }
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) return true;
+    }
+    return false;
 #else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
+    return i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0;
 #endif
+}
+
+#ifdef ISSI_ASYNC
+// Bit n of g_pwm_buffer_failed is set from the I2C thread when a queued
+// write of span n has failed, until the next update marks it dirty again.
+static volatile uint16_t g_pwm_buffer_failed = 0;
+
+static void IS31FL3736_queued_pwm_span_done(i2c_status_t status, void *arg) {
+    if (status != I2C_STATUS_SUCCESS) {
+        uint8_t span = (uintptr_t)arg;
+        ATOMIC_BLOCK_FORCEON { g_pwm_buffer_failed |= 1 << span; }
+    }
+}
+
+static bool IS31FL3736_queue_pwm_span(uint8_t addr, uint8_t *pwm_buffer, uint8_t span) {
+    // assumes PG1 is already selected
+    // returns false if the write could not be queued
+    IS31FL3736_fill_pwm_span(pwm_buffer, span);
+    return i2c_transmit_async(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT, IS31FL3736_queued_pwm_span_done, (void *)(uintptr_t)span) == I2C_STATUS_SUCCESS;
+}
+#endif
+
+void IS31FL3736_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    // assumes PG1 is already selected
+
+    // transmit PWM registers in 12 transfers of 16 bytes
+    for (uint8_t span = 0; span < 12; span++) {
+        IS31FL3736_write_pwm_span(addr, pwm_buffer, span);
     }
 }
 
@@ -162,15 +206,23 @@ void IS31FL3736_init(uint8_t addr) {
     wait_ms(10);
 }
 
+static inline void IS31FL3736_set_pwm(uint8_t driver, uint8_t reg, uint8_t value) {
+    // only mark the span dirty if the value actually changes, so frames
+    // which repaint the same colors do not cause any I2C traffic
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_dirty |= 1 << (reg / 16);
+    }
+}
+
 void IS31FL3736_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     is31_led led;
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         memcpy_P(&led, (&g_is31_leds[index]), sizeof(led));
 
-        g_pwm_buffer[led.driver][led.r] = red;
-        g_pwm_buffer[led.driver][led.g] = green;
-        g_pwm_buffer[led.driver][led.b] = blue;
-        g_pwm_buffer_update_required    = true;
+        IS31FL3736_set_pwm(led.driver, led.r, red);
+        IS31FL3736_set_pwm(led.driver, led.g, green);
+        IS31FL3736_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -228,9 +280,8 @@ void IS31FL3736_mono_set_brightness(int index, uint8_t value) {
     if (index >= 0 && index < 96) {
         // Index in range 0..95 -> A1..A8, B1..B8, etc.
         // Map index 0..95 to registers 0x00..0xBE (interleaved)
-        uint8_t pwm_register          = index * 2;
-        g_pwm_buffer[0][pwm_register] = value;
-        g_pwm_buffer_update_required  = true;
+        uint8_t pwm_register = index * 2;
+        IS31FL3736_set_pwm(0, pwm_register, value);
     }
 }
 
@@ -259,15 +310,36 @@ void IS31FL3736_mono_set_led_control_register(uint8_t index, bool enabled) {
 }
 
 void IS31FL3736_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
-    if (g_pwm_buffer_update_required) {
+#ifdef ISSI_ASYNC
+    // queued spans that failed to write since the last update are written again
+    uint16_t failed;
+    ATOMIC_BLOCK_FORCEON {
+        failed              = g_pwm_buffer_failed;
+        g_pwm_buffer_failed = 0;
+    }
+    g_pwm_buffer_dirty |= failed;
+#endif
+    if (g_pwm_buffer_dirty) {
         // Firstly we need to unlock the command register and select PG1
         IS31FL3736_write_register(addr1, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
         IS31FL3736_write_register(addr1, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
 
-        IS31FL3736_write_pwm_buffer(addr1, g_pwm_buffer[0]);
-        // IS31FL3736_write_pwm_buffer(addr2, g_pwm_buffer[1]);
+        // Only write the spans which changed since the last update,
+        // spans that fail to write stay dirty so they are retried next time
+        for (uint8_t span = 0; span < 12; span++) {
+            if (g_pwm_buffer_dirty & (1 << span)) {
+#ifdef ISSI_ASYNC
+                bool written = IS31FL3736_queue_pwm_span(addr1, g_pwm_buffer[0], span);
+#else
+                bool written = IS31FL3736_write_pwm_span(addr1, g_pwm_buffer[0], span);
+#endif
+                // IS31FL3736_write_pwm_span(addr2, g_pwm_buffer[1], span);
+                if (written) {
+                    g_pwm_buffer_dirty &= ~(1 << span);
+                }
+            }
+        }
     }
-    g_pwm_buffer_update_required = false;
 }
 
 void IS31FL3736_update_led_control_registers(uint8_t addr1, uint8_t addr2) {
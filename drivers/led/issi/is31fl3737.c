@@ -57,6 +57,18 @@
 #    define ISSI_PERSISTENCE 0
 #endif
 
+// With I2C_ASYNC_ENABLE writes are queued and the transfer buffer is copied,
+// so a frame update returns without waiting for the bus. A PWM span that fails
+// to write is picked up again by the next update. Retrying with
+// ISSI_PERSISTENCE needs the result of every write, so that stays blocking.
+#if defined(I2C_ASYNC_ENABLE) && ISSI_PERSISTENCE == 0
+#    define ISSI_ASYNC
+#    include "atomic_util.h"
+#    define ISSI_TRANSMIT(addr, data, length) i2c_transmit_async(addr, data, length, ISSI_TIMEOUT, NULL, NULL)
+#else
+#    define ISSI_TRANSMIT(addr, data, length) i2c_transmit(addr, data, length, ISSI_TIMEOUT)
+#endif
+
 #ifndef ISSI_SWPULLUP
 #    define ISSI_SWPULLUP PUR_0R
 #endif
@@ -75,8 +87,10 @@ uint8_t g_twi_transfer_buffer[20];
 // buffers and the transfers in IS31FL3737_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
 
-uint8_t g_pwm_buffer[DRIVER_COUNT][192];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT] = {false};
+// Bit n of g_pwm_buffer_dirty is set when registers 16*n to 16*n+15
+// have changed since they were last written.
+uint8_t  g_pwm_buffer[DRIVER_COUNT][192];
+uint16_t g_pwm_buffer_dirty[DRIVER_COUNT] = {0};
 
 uint8_t g_led_control_registers[DRIVER_COUNT][24]             = {0};
 bool    g_led_control_registers_update_required[DRIVER_COUNT] = {false};
@@ -87,36 +101,67 @@ void IS31FL3737_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 
 #if ISSI_PERSISTENCE > 0
     for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0) break;
+        if (ISSI_TRANSMIT(addr << 1, g_twi_transfer_buffer, 2) == 0) break;
     }
 #else
-    i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT);
+    ISSI_TRANSMIT(addr << 1, g_twi_transfer_buffer, 2);
 #endif
 }
 
-void IS31FL3737_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
-    // assumes PG1 is already selected
-
-    // transmit PWM registers in 12 transfers of 16 bytes
+static void IS31FL3737_fill_pwm_span(uint8_t *pwm_buffer, uint8_t span) {
     // g_twi_transfer_buffer[] is 20 bytes
 
-    // iterate over the pwm_buffer contents at 16 byte intervals
-    for (int i = 0; i < 192; i += 16) {
-        g_twi_transfer_buffer[0] = i;
-        // copy the data from i to i+15
-        // device will auto-increment register for data after the first byte
-        // thus this sets registers 0x00-0x0F, 0x10-0x1F, etc. in one transfer
-        for (int j = 0; j < 16; j++) {
-            g_twi_transfer_buffer[1 + j] = pwm_buffer[i + j];
-        }
+    // set the first register, e.g. 0x00, 0x10, 0x20, etc.
+    g_twi_transfer_buffer[0] = span * 16;
+    // copy the data from span*16 to span*16+15
+    // device will auto-increment register for data after the first byte
+    for (int j = 0; j < 16; j++) {
+        g_twi_transfer_buffer[1 + j] = pwm_buffer[span * 16 + j];
+    }
+}
+
+static bool IS31FL3737_write_pwm_span(uint8_t addr, uint8_t *pwm_buffer, uint8_t span) {
+    // assumes PG1 is already selected
+    // returns false if the write failed
+    IS31FL3737_fill_pwm_span(pwm_buffer, span);
 
 #if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) break;
-        }
+    for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0) return true;
+    }
+    return false;
 #else
-        i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT);
+    return i2c_transmit(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT) == 0;
 #endif
+}
+
+#ifdef ISSI_ASYNC
+// Bit n of g_pwm_buffer_failed is set from the I2C thread when a queued
+// write of span n has failed, until the next update marks it dirty again.
+static volatile uint16_t g_pwm_buffer_failed[DRIVER_COUNT] = {0};
+
+static void IS31FL3737_queued_pwm_span_done(i2c_status_t status, void *arg) {
+    if (status != I2C_STATUS_SUCCESS) {
+        uint8_t index = (uintptr_t)arg / 12;
+        uint8_t span  = (uintptr_t)arg % 12;
+        ATOMIC_BLOCK_FORCEON { g_pwm_buffer_failed[index] |= 1 << span; }
+    }
+}
+
+static bool IS31FL3737_queue_pwm_span(uint8_t addr, uint8_t index, uint8_t span) {
+    // assumes PG1 is already selected
+    // returns false if the write could not be queued
+    IS31FL3737_fill_pwm_span(g_pwm_buffer[index], span);
+    return i2c_transmit_async(addr << 1, g_twi_transfer_buffer, 17, ISSI_TIMEOUT, IS31FL3737_queued_pwm_span_done, (void *)(uintptr_t)(index * 12 + span)) == I2C_STATUS_SUCCESS;
+}
+#endif
+
+void IS31FL3737_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    // assumes PG1 is already selected
+
+    // transmit PWM registers in 12 transfers of 16 bytes
+    for (uint8_t span = 0; span < 12; span++) {
+        IS31FL3737_write_pwm_span(addr, pwm_buffer, span);
     }
 }
 
@@ -165,15 +210,23 @@ void IS31FL3737_init(uint8_t addr) {
     wait_ms(10);
 }
 
+static inline void IS31FL3737_set_pwm(uint8_t driver, uint8_t reg, uint8_t value) {
+    // only mark the span dirty if the value actually changes, so frames
+    // which repaint the same colors do not cause any I2C traffic
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_dirty[driver] |= 1 << (reg / 16);
+    }
+}
+
 void IS31FL3737_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     is31_led led;
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         memcpy_P(&led, (&g_is31_leds[index]), sizeof(led));
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3737_set_pwm(led.driver, led.r, red);
+        IS31FL3737_set_pwm(led.driver, led.g, green);
+        IS31FL3737_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -214,14 +267,35 @@ void IS31FL3737_set_led_control_register(uint8_t index, bool red, bool green, bo
 }
 
 void IS31FL3737_update_pwm_buffers(uint8_t addr, uint8_t index) {
-    if (g_pwm_buffer_update_required[index]) {
+#ifdef ISSI_ASYNC
+    // queued spans that failed to write since the last update are written again
+    uint16_t failed;
+    ATOMIC_BLOCK_FORCEON {
+        failed                     = g_pwm_buffer_failed[index];
+        g_pwm_buffer_failed[index] = 0;
+    }
+    g_pwm_buffer_dirty[index] |= failed;
+#endif
+    if (g_pwm_buffer_dirty[index]) {
         // Firstly we need to unlock the command register and select PG1
         IS31FL3737_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
         IS31FL3737_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM);
 
-        IS31FL3737_write_pwm_buffer(addr, g_pwm_buffer[index]);
+        // Only write the spans which changed since the last update,
+        // spans that fail to write stay dirty so they are retried next time
+        for (uint8_t span = 0; span < 12; span++) {
+            if (g_pwm_buffer_dirty[index] & (1 << span)) {
+#ifdef ISSI_ASYNC
+                bool written = IS31FL3737_queue_pwm_span(addr, index, span);
+#else
+                bool written = IS31FL3737_write_pwm_span(addr, g_pwm_buffer[index], span);
+#endif
+                if (written) {
+                    g_pwm_buffer_dirty[index] &= ~(1 << span);
+                }
+            }
+        }
     }
-    g_pwm_buffer_update_required[index] = false;
 }
 
 void IS31FL3737_update_led_control_registers(uint8_t addr, uint8_t index) {
@@ -61,6 +61,18 @@
 #    define ISSI_PERSISTENCE 0
 #endif
 
+// With I2C_ASYNC_ENABLE writes are queued and the transfer buffer is copied,
+// so a frame update returns without waiting for the bus. A PWM span that fails
+// to write is picked up again by the next update. Retrying with
+// ISSI_PERSISTENCE needs the result of every write, so that stays blocking.
+#if defined(I2C_ASYNC_ENABLE) && ISSI_PERSISTENCE == 0
+#    define ISSI_ASYNC
+#    include "atomic_util.h"
+#    define ISSI_TRANSMIT(addr, data, length) i2c_transmit_async(addr, data, length, ISSI_TIMEOUT, NULL, NULL)
+#else
+#    define ISSI_TRANSMIT(addr, data, length) i2c_transmit(addr, data, length, ISSI_TIMEOUT)
+#endif
+
 #ifndef ISSI_SWPULLUP
 #    define ISSI_SWPULLUP PUR_32KR
 #endif
@@ -80,9 +92,11 @@ uint8_t g_twi_transfer_buffer[20] = {0xFF};
 // We could optimize this and take out the unused registers from these
 // buffers and the transfers in IS31FL3741_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
-uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
-bool    g_pwm_buffer_update_required[DRIVER_COUNT]        = {false};
-bool    g_scaling_registers_update_required[DRIVER_COUNT] = {false};
+// Bit n of g_pwm_buffer_dirty is set when the 18 bytes starting at
+// g_pwm_buffer[n * 18] have changed since they were last written.
+uint8_t  g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
+uint32_t g_pwm_buffer_dirty[DRIVER_COUNT]                  = {0};
+bool     g_scaling_registers_update_required[DRIVER_COUNT] = {false};
 
 uint8_t g_scaling_registers[DRIVER_COUNT][ISSI_MAX_LEDS];
 
@@ -92,53 +106,41 @@ void IS31FL3741_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 
 #if ISSI_PERSISTENCE > 0
     for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT) == 0) break;
+        if (ISSI_TRANSMIT(addr << 1, g_twi_transfer_buffer, 2) == 0) break;
     }
 #else
-    i2c_transmit(addr << 1, g_twi_transfer_buffer, 2, ISSI_TIMEOUT);
+    ISSI_TRANSMIT(addr << 1, g_twi_transfer_buffer, 2);
 #endif
 }
 
-bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
-    // unlock the command register and select PG2
-    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM0);
-
-    for (int i = 0; i < 342; i += 18) {
-        if (i == 180) {
-            // unlock the command register and select PG2
-            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM1);
-        }
+// The PWM registers are transferred in spans of 18 bytes. Spans 0-9 are on PG0,
+// spans 10-19 on PG1, the last one being only 9 bytes long as there are 351 registers.
+#define ISSI_PWM_SPAN_SIZE 18
+#define ISSI_PWM_SPAN_COUNT ((ISSI_MAX_LEDS + ISSI_PWM_SPAN_SIZE - 1) / ISSI_PWM_SPAN_SIZE)
+#define ISSI_PWM_PAGE_SIZE 180
 
-        g_twi_transfer_buffer[0] = i % 180;
-        memcpy(g_twi_transfer_buffer + 1, pwm_buffer + i, 18);
+// Fills the transfer buffer with a span, returning the length of the transfer
+static uint8_t IS31FL3741_fill_pwm_span(uint8_t *pwm_buffer, uint8_t span) {
+    uint16_t start = span * ISSI_PWM_SPAN_SIZE;
+    uint8_t  size  = ISSI_MAX_LEDS - start < ISSI_PWM_SPAN_SIZE ? ISSI_MAX_LEDS - start : ISSI_PWM_SPAN_SIZE;
 
-#if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
-                return false;
-            }
-        }
-#else
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
-            return false;
-        }
-#endif
-    }
+    g_twi_transfer_buffer[0] = start % ISSI_PWM_PAGE_SIZE;
+    memcpy(g_twi_transfer_buffer + 1, pwm_buffer + start, size);
+    return size + 1;
+}
 
-    // transfer the left cause the total number is 351
-    g_twi_transfer_buffer[0] = 162;
-    memcpy(g_twi_transfer_buffer + 1, pwm_buffer + 342, 9);
+static bool IS31FL3741_write_pwm_span(uint8_t addr, uint8_t *pwm_buffer, uint8_t span) {
+    // assumes the page holding the span is already selected
+    uint8_t length = IS31FL3741_fill_pwm_span(pwm_buffer, span);
 
 #if ISSI_PERSISTENCE > 0
     for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length, ISSI_TIMEOUT) != 0) {
             return false;
         }
     }
 #else
-    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
+    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length, ISSI_TIMEOUT) != 0) {
         return false;
     }
 #endif
@@ -146,6 +148,71 @@ bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
     return true;
 }
 
+static void IS31FL3741_select_pwm_page(uint8_t addr, uint8_t span, bool page_selected[2]) {
+    uint8_t page = span * ISSI_PWM_SPAN_SIZE >= ISSI_PWM_PAGE_SIZE;
+    if (!page_selected[page]) {
+        // unlock the command register and select PG0 or PG1
+        IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
+        IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, page ? ISSI_PAGE_PWM1 : ISSI_PAGE_PWM0);
+        page_selected[page] = true;
+    }
+}
+
+// Returns the spans that were not written, starting with the first one that failed
+static uint32_t IS31FL3741_write_pwm_spans(uint8_t addr, uint8_t *pwm_buffer, uint32_t spans) {
+    bool page_selected[2] = {false, false};
+
+    for (uint8_t span = 0; span < ISSI_PWM_SPAN_COUNT; span++) {
+        if (!(spans & ((uint32_t)1 << span))) {
+            continue;
+        }
+
+        IS31FL3741_select_pwm_page(addr, span, page_selected);
+        if (!IS31FL3741_write_pwm_span(addr, pwm_buffer, span)) {
+            return spans;
+        }
+        spans &= ~((uint32_t)1 << span);
+    }
+
+    return 0;
+}
+
+#ifdef ISSI_ASYNC
+// Bit n of g_pwm_buffer_failed is set from the I2C thread when a queued write
+// of span n has failed, until the next update marks it dirty again.
+static volatile uint32_t g_pwm_buffer_failed[DRIVER_COUNT] = {0};
+
+static void IS31FL3741_queued_pwm_span_done(i2c_status_t status, void *arg) {
+    if (status != I2C_STATUS_SUCCESS) {
+        uint8_t index = (uintptr_t)arg / ISSI_PWM_SPAN_COUNT;
+        uint8_t span  = (uintptr_t)arg % ISSI_PWM_SPAN_COUNT;
+        ATOMIC_BLOCK_FORCEON { g_pwm_buffer_failed[index] |= (uint32_t)1 << span; }
+    }
+}
+
+// Returns the spans that could not be queued, starting with the first one that failed
+static uint32_t IS31FL3741_queue_pwm_spans(uint8_t addr, uint8_t index, uint32_t spans) {
+    bool page_selected[2] = {false, false};
+
+    for (uint8_t span = 0; span < ISSI_PWM_SPAN_COUNT; span++) {
+        if (!(spans & ((uint32_t)1 << span))) {
+            continue;
+        }
+
+        IS31FL3741_select_pwm_page(addr, span, page_selected);
+        uint8_t length = IS31FL3741_fill_pwm_span(g_pwm_buffer[index], span);
+        if (i2c_transmit_async(addr << 1, g_twi_transfer_buffer, length, ISSI_TIMEOUT, IS31FL3741_queued_pwm_span_done, (void *)(uintptr_t)(index * ISSI_PWM_SPAN_COUNT + span)) != I2C_STATUS_SUCCESS) {
+            return spans;
+        }
+        spans &= ~((uint32_t)1 << span);
+    }
+
+    return 0;
+}
+#endif
+
+bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) { return IS31FL3741_write_pwm_spans(addr, pwm_buffer, ((uint32_t)1 << ISSI_PWM_SPAN_COUNT) - 1) == 0; }
+
 void IS31FL3741_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -173,15 +240,23 @@ void IS31FL3741_init(uint8_t addr) {
     wait_ms(10);
 }
 
+static inline void IS31FL3741_set_pwm(uint8_t driver, uint16_t reg, uint8_t value) {
+    // only mark the span dirty if the value actually changes, so frames
+    // which repaint the same colors do not cause any I2C traffic
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_dirty[driver] |= (uint32_t)1 << (reg / ISSI_PWM_SPAN_SIZE);
+    }
+}
+
 void IS31FL3741_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     is31_led led;
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         memcpy_P(&led, (&g_is31_leds[index]), sizeof(led));
 
-        g_pwm_buffer[led.driver][led.r]          = red;
-        g_pwm_buffer[led.driver][led.g]          = green;
-        g_pwm_buffer[led.driver][led.b]          = blue;
-        g_pwm_buffer_update_required[led.driver] = true;
+        IS31FL3741_set_pwm(led.driver, led.r, red);
+        IS31FL3741_set_pwm(led.driver, led.g, green);
+        IS31FL3741_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -217,19 +292,31 @@ void IS31FL3741_set_led_control_register(uint8_t index, bool red, bool green, bo
 }
 
 void IS31FL3741_update_pwm_buffers(uint8_t addr, uint8_t index) {
-    if (g_pwm_buffer_update_required[index]) {
-        IS31FL3741_write_pwm_buffer(addr, g_pwm_buffer[index]);
+#ifdef ISSI_ASYNC
+    // queued spans that failed to write since the last update are written again
+    uint32_t failed;
+    ATOMIC_BLOCK_FORCEON {
+        failed                     = g_pwm_buffer_failed[index];
+        g_pwm_buffer_failed[index] = 0;
     }
+    g_pwm_buffer_dirty[index] |= failed;
+#endif
 
-    g_pwm_buffer_update_required[index] = false;
+    // only write the spans which changed since the last update, spans that
+    // could not be written stay dirty so they are retried next time
+    if (g_pwm_buffer_dirty[index]) {
+#ifdef ISSI_ASYNC
+        g_pwm_buffer_dirty[index] = IS31FL3741_queue_pwm_spans(addr, index, g_pwm_buffer_dirty[index]);
+#else
+        g_pwm_buffer_dirty[index] = IS31FL3741_write_pwm_spans(addr, g_pwm_buffer[index], g_pwm_buffer_dirty[index]);
+#endif
+    }
 }
 
 void IS31FL3741_set_pwm_buffer(const is31_led *pled, uint8_t red, uint8_t green, uint8_t blue) {
-    g_pwm_buffer[pled->driver][pled->r] = red;
-    g_pwm_buffer[pled->driver][pled->g] = green;
-    g_pwm_buffer[pled->driver][pled->b] = blue;
-
-    g_pwm_buffer_update_required[pled->driver] = true;
+    IS31FL3741_set_pwm(pled->driver, pled->r, red);
+    IS31FL3741_set_pwm(pled->driver, pled->g, green);
+    IS31FL3741_set_pwm(pled->driver, pled->b, blue);
 }
 
 void IS31FL3741_update_led_control_registers(uint8_t addr, uint8_t index) {
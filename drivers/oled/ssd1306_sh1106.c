@@ -26,6 +26,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "keyboard.h"
 
+#if defined(I2C_ASYNC_ENABLE)
+#    include "atomic_util.h"
+#endif
+
 // Used commands from spec sheet: https://cdn-shop.adafruit.com/datasheets/SSD1306.pdf
 // for SH1106: https://www.velleman.eu/downloads/29/infosheets/sh1106_datasheet.pdf
 
@@ -102,6 +106,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif  // defined(__AVR__)
 #define I2C_TRANSMIT(data) i2c_transmit((OLED_DISPLAY_ADDRESS << 1), &data[0], sizeof(data), OLED_I2C_TIMEOUT)
 #define I2C_WRITE_REG(mode, data, size) i2c_writeReg((OLED_DISPLAY_ADDRESS << 1), mode, data, size, OLED_I2C_TIMEOUT)
+#if defined(I2C_ASYNC_ENABLE)
+// Only render data is queued, commands stay blocking so their failures are still reported.
+// Queued transfers copy their data, so render can move on to the next block straight away.
+#    define I2C_RENDER_WRITE_REG(block, data, size) i2c_writeReg_async((OLED_DISPLAY_ADDRESS << 1), I2C_DATA, data, size, OLED_I2C_TIMEOUT, oled_render_done, (void *)(uintptr_t)block)
+#else
+#    define I2C_RENDER_WRITE_REG(block, data, size) I2C_WRITE_REG(I2C_DATA, data, size)
+#endif
 
 #define HAS_FLAGS(bits, flags) ((bits & flags) == flags)
 
@@ -132,6 +143,19 @@ uint32_t oled_scroll_timeout;
 uint16_t oled_update_timeout;
 #endif
 
+#if defined(I2C_ASYNC_ENABLE)
+// Bit n of oled_render_failed is set from the I2C thread when the queued
+// data write of block n has failed, until the next render marks it dirty again.
+static volatile OLED_BLOCK_TYPE oled_render_failed = 0;
+
+static void oled_render_done(i2c_status_t status, void *arg) {
+    if (status != I2C_STATUS_SUCCESS) {
+        uint8_t block = (uintptr_t)arg;
+        ATOMIC_BLOCK_FORCEON { oled_render_failed |= (OLED_BLOCK_TYPE)1 << block; }
+    }
+}
+#endif
+
 // Internal variables to reduce math instructions
 
 #if defined(__AVR__)
@@ -291,6 +315,15 @@ void oled_render(void) {
         return;
     }
 
+#if defined(I2C_ASYNC_ENABLE)
+    OLED_BLOCK_TYPE failed;
+    ATOMIC_BLOCK_FORCEON {
+        failed             = oled_render_failed;
+        oled_render_failed = 0;
+    }
+    oled_dirty |= failed;
+#endif
+
     // Do we have work to do?
     oled_dirty &= OLED_ALL_BLOCKS_MASK;
     if (!oled_dirty || oled_scrolling) {
@@ -319,7 +352,7 @@ void oled_render(void) {
 
     if (!HAS_FLAGS(oled_rotation, OLED_ROTATION_90)) {
         // Send render data chunk as is
-        if (I2C_WRITE_REG(I2C_DATA, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
+        if (I2C_RENDER_WRITE_REG(update_start, &oled_buffer[OLED_BLOCK_SIZE * update_start], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
             print("oled_render data failed\n");
             return;
         }
@@ -335,7 +368,7 @@ void oled_render(void) {
         }
 
         // Send render data chunk after rotating
-        if (I2C_WRITE_REG(I2C_DATA, &temp_buffer[0], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
+        if (I2C_RENDER_WRITE_REG(update_start, &temp_buffer[0], OLED_BLOCK_SIZE) != I2C_STATUS_SUCCESS) {
             print("oled_render90 data failed\n");
             return;
         }
@@ -79,8 +79,8 @@ void ps2_mouse_task(void) {
     rcv = ps2_host_send(PS2_MOUSE_READ_DATA);
     if (rcv == PS2_ACK) {
         mouse_report.buttons = ps2_host_recv_response() | tp_buttons;
-        mouse_report.x       = ps2_host_recv_response() * PS2_MOUSE_X_MULTIPLIER;
-        mouse_report.y       = ps2_host_recv_response() * PS2_MOUSE_Y_MULTIPLIER;
+        mouse_report.x       = (int8_t)(ps2_host_recv_response() * PS2_MOUSE_X_MULTIPLIER);
+        mouse_report.y       = (int8_t)(ps2_host_recv_response() * PS2_MOUSE_Y_MULTIPLIER);
 #ifdef PS2_MOUSE_ENABLE_SCROLLING
         mouse_report.v = -(ps2_host_recv_response() & PS2_MOUSE_SCROLL_MASK) * PS2_MOUSE_V_MULTIPLIER;
 #endif
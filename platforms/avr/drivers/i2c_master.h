@@ -19,6 +19,10 @@
 
 #pragma once
 
+#ifdef I2C_ASYNC_ENABLE
+#    error "I2C_ASYNC_ENABLE is only supported on ChibiOS"
+#endif
+
 #define I2C_READ 0x01
 #define I2C_WRITE 0x00
 
@@ -41,6 +41,9 @@ typedef uint8_t port_data_t;
 
 #define readPort(port) PINx_ADDRESS(port)
 
+#define getPinPort(pin) ((pin) >> PORT_SHIFTER)
+#define getPinPortBit(pin) ((pin)&0xF)
+
 #define setPortBitInput(port, bit) (DDRx_ADDRESS(port) &= ~_BV((bit)&0xF), PORTx_ADDRESS(port) &= ~_BV((bit)&0xF))
 #define setPortBitInputHigh(port, bit) (DDRx_ADDRESS(port) &= ~_BV((bit)&0xF), PORTx_ADDRESS(port) |= _BV((bit)&0xF))
 #define setPortBitOutput(port, bit) (DDRx_ADDRESS(port) |= _BV((bit)&0xF))
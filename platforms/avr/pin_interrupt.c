@@ -0,0 +1,25 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pin_interrupt.h"
+
+/* Which pin-change and external interrupts are wired to which pins differs across every AVR part, so
+ * no pin can be armed and callers fall back to polling.
+ */
+
+bool pin_interrupt_enable(pin_t pin, pin_interrupt_edge_t edge, pin_interrupt_callback_t callback, void *arg) { return false; }
+
+void pin_interrupt_disable(pin_t pin) {}
@@ -0,0 +1,44 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <avr/sleep.h>
+#include <avr/interrupt.h>
+#include "pin_wakeup.h"
+
+/* Which pin-change and external interrupts are wired to which pins differs across every AVR part, so
+ * pins are not armed individually. Instead the MCU idles until the next interrupt, which is at most the
+ * 1ms system tick away, and the caller polls its pins when it wakes.
+ */
+
+bool pin_wakeup_enable(pin_t pin) { return false; }
+
+void pin_wakeup_disable(pin_t pin) {}
+
+void pin_wakeup_signal_from_isr(void) {}
+
+bool pin_wakeup_wait(uint32_t timeout_ms, uint32_t *edge_time) {
+    if (timeout_ms == 0) {
+        return false;
+    }
+
+    cli();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+    return false;
+}
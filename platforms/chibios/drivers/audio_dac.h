@@ -124,3 +124,10 @@
  *user overridable sample generation/processing
  */
 uint16_t dac_value_generate(void);
+
+/**
+ * share of the time between two DAC buffer callbacks, in percent, that the
+ * last callback spent rendering its half of the buffer (dac_additive only).
+ * always 0 on cores without a cycle counter.
+ */
+uint8_t audio_dac_get_load(void);
@@ -79,14 +79,32 @@ static const dacsample_t dac_buffer_trapezoid[AUDIO_DAC_BUFFER_SIZE] = {0x0,   0
                                                                         0xfff, 0xfdf, 0xf7f, 0xf1f, 0xebf, 0xe5f, 0xdff, 0xd9f, 0xd3f, 0xcdf, 0xc7f, 0xc1f, 0xbbf, 0xb5f, 0xaff, 0xa9f, 0xa3f, 0x9df, 0x97f, 0x91f, 0x8bf, 0x85f, 0x7ff, 0x79f, 0x73f, 0x6df, 0x67f, 0x61f, 0x5bf, 0x55f, 0x4ff, 0x49f, 0x43f, 0x3df, 0x37f, 0x31f, 0x2bf, 0x25f, 0x1ff, 0x19f, 0x13f, 0xdf,  0x7f,  0x1f,  0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0,   0x0};
 #endif  // AUDIO_DAC_SAMPLE_WAVEFORM_TRAPEZOID
 
+#if defined(AUDIO_DAC_SAMPLE_WAVEFORM_SINE)
+#    define DAC_WAVETABLE dac_buffer_sine
+#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_TRIANGLE)
+#    define DAC_WAVETABLE dac_buffer_triangle
+#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_TRAPEZOID)
+#    define DAC_WAVETABLE dac_buffer_trapezoid
+#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_SQUARE)
+#    define DAC_WAVETABLE dac_buffer_square
+#endif
+
 static dacsample_t dac_buffer_empty[AUDIO_DAC_BUFFER_SIZE] = {AUDIO_DAC_OFF_VALUE};
 
-/* keep track of the sample position for for each frequency */
-static float dac_if[AUDIO_MAX_SIMULTANEOUS_TONES] = {0.0};
+/* keep track of the sample position for each frequency, as a 0.32 fixed point fraction of one pass
+ * through the wavetable - so the phase wraps around on its own, without any float math or fmod
+ */
+static uint32_t dac_phase[AUDIO_MAX_SIMULTANEOUS_TONES]           = {0};
+static uint32_t dac_phase_increment[AUDIO_MAX_SIMULTANEOUS_TONES] = {0};
 
 static float   active_tones_snapshot[AUDIO_MAX_SIMULTANEOUS_TONES] = {0, 0};
 static uint8_t active_tones_snapshot_length                        = 0;
 
+#if PORT_SUPPORTS_RT == TRUE
+static rtcnt_t dac_block_last_start = 0;
+static uint8_t dac_block_load       = 0;
+#endif
+
 typedef enum {
     OUTPUT_SHOULD_START,
     OUTPUT_RUN_NORMALLY,
@@ -114,51 +132,34 @@ __attribute__((weak)) uint16_t dac_value_generate(void) {
     }
 
     /* doing additive wave synthesis over all currently playing tones = adding up
-     * sine-wave-samples for each frequency, scaled by the number of active tones
+     * wavetable-samples for each frequency, scaled once by the number of active tones
      */
-    uint16_t value     = 0;
-    float    frequency = 0.0f;
+    uint32_t value = 0;
 
     for (uint8_t i = 0; i < active_tones_snapshot_length; i++) {
         /* Note: a user implementation does not have to rely on the active_tones_snapshot, but
          * could directly query the active frequencies through audio_get_processed_frequency */
-        frequency = active_tones_snapshot[i];
-
-        dac_if[i] = dac_if[i] + ((frequency * AUDIO_DAC_BUFFER_SIZE) / AUDIO_DAC_SAMPLE_RATE) * 2 / 3;
-        /*Note: the 2/3 are necessary to get the correct frequencies on the
-         *      DAC output (as measured with an oscilloscope), since the gpt
-         *      timer runs with 3*AUDIO_DAC_SAMPLE_RATE; and the DAC callback
-         *      is called twice per conversion.*/
-
-        dac_if[i] = fmod(dac_if[i], AUDIO_DAC_BUFFER_SIZE);
-
-        // Wavetable generation/lookup
-        uint16_t dac_i = (uint16_t)dac_if[i];
+        dac_phase[i] += dac_phase_increment[i];
 
-#if defined(AUDIO_DAC_SAMPLE_WAVEFORM_SINE)
-        value += dac_buffer_sine[dac_i] / active_tones_snapshot_length;
-#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_TRIANGLE)
-        value += dac_buffer_triangle[dac_i] / active_tones_snapshot_length;
-#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_TRAPEZOID)
-        value += dac_buffer_trapezoid[dac_i] / active_tones_snapshot_length;
-#elif defined(AUDIO_DAC_SAMPLE_WAVEFORM_SQUARE)
-        value += dac_buffer_square[dac_i] / active_tones_snapshot_length;
-#endif
-        /*
-        // SINE
-        value += dac_buffer_sine[dac_i] / active_tones_snapshot_length / 3;
-        // TRIANGLE
-        value += dac_buffer_triangle[dac_i] / active_tones_snapshot_length / 3;
-        // SQUARE
-        value += dac_buffer_square[dac_i] / active_tones_snapshot_length / 3;
-        //NOTE: combination of these three wave-forms is more exemplary - and doesn't sound particularly good :-P
-        */
+        // Wavetable lookup: the upper bits of the phase are the index into the table
+        value += DAC_WAVETABLE[((uint64_t)dac_phase[i] * AUDIO_DAC_BUFFER_SIZE) >> 32];
 
         // STAIRS (mostly usefully as test-pattern)
-        // value_avg = dac_buffer_staircase[dac_i] / active_tones_snapshot_length;
+        // value += dac_buffer_staircase[((uint64_t)dac_phase[i] * AUDIO_DAC_BUFFER_SIZE) >> 32];
     }
 
-    return value;
+    return value / active_tones_snapshot_length;
+}
+
+/**
+ * Phase increment per sample for a given frequency, as fraction of one pass through the wavetable.
+ */
+static uint32_t dac_phase_increment_for(float frequency) {
+    /*Note: the 2/3 are necessary to get the correct frequencies on the
+     *      DAC output (as measured with an oscilloscope), since the gpt
+     *      timer runs with 3*AUDIO_DAC_SAMPLE_RATE; and the DAC callback
+     *      is called twice per conversion.*/
+    return (uint32_t)(frequency * (4294967296.0f * 2 / 3 / AUDIO_DAC_SAMPLE_RATE));
 }
 
 /**
@@ -167,6 +168,9 @@ __attribute__((weak)) uint16_t dac_value_generate(void) {
  * Note: chibios calls this CB twice: during the 'half buffer event', and the 'full buffer event'.
  */
 static void dac_end(DACDriver *dacp) {
+#if PORT_SUPPORTS_RT == TRUE
+    rtcnt_t block_start = chSysGetRealtimeCounterX();
+#endif
     dacsample_t *sample_p = (dacp)->samples;
 
     // work on the other half of the buffer
@@ -174,7 +178,15 @@ static void dac_end(DACDriver *dacp) {
         sample_p += AUDIO_DAC_BUFFER_SIZE / 2;  // 'half_index'
     }
 
-    for (uint8_t s = 0; s < AUDIO_DAC_BUFFER_SIZE / 2; s++) {
+    uint8_t s = 0;
+    if (OUTPUT_RUN_NORMALLY == state) {
+        // nothing to wait for - render the whole block without checking for zero crossings
+        for (; s < AUDIO_DAC_BUFFER_SIZE / 2; s++) {
+            sample_p[s] = dac_value_generate();
+        }
+    }
+
+    for (; s < AUDIO_DAC_BUFFER_SIZE / 2; s++) {
         if (OUTPUT_OFF <= state) {
             sample_p[s] = AUDIO_DAC_OFF_VALUE;
             continue;
@@ -221,6 +233,7 @@ static void dac_end(DACDriver *dacp) {
             for (uint8_t i = 0; i < active_tones; i++) {
                 float freq = audio_get_processed_frequency(i);
                 if (freq > 0) {  // disregard 'rest' notes, with valid frequency 0.0f; which would only lower the resulting waveform volume during the additive synthesis step
+                    dac_phase_increment[active_tones_snapshot_length]     = dac_phase_increment_for(freq);
                     active_tones_snapshot[active_tones_snapshot_length++] = freq;
                 }
             }
@@ -249,6 +262,24 @@ static void dac_end(DACDriver *dacp) {
             state++;
         }
     }
+
+#if PORT_SUPPORTS_RT == TRUE
+    // time spent rendering this block, relative to the time since the previous one started
+    rtcnt_t block_end    = chSysGetRealtimeCounterX();
+    rtcnt_t block_period = block_start - dac_block_last_start;
+    if (block_period > 0) {
+        dac_block_load = MIN(100, (uint64_t)(block_end - block_start) * 100 / block_period);
+    }
+    dac_block_last_start = block_start;
+#endif
+}
+
+uint8_t audio_dac_get_load(void) {
+#if PORT_SUPPORTS_RT == TRUE
+    return dac_block_load;
+#else
+    return 0;
+#endif
 }
 
 static void dac_error(DACDriver *dacp, dacerror_t err) {
@@ -327,7 +358,8 @@ void audio_driver_start(void) {
     gptStartContinuous(&GPTD6, 2U);
 
     for (uint8_t i = 0; i < AUDIO_MAX_SIMULTANEOUS_TONES; i++) {
-        dac_if[i]                = 0.0f;
+        dac_phase[i]             = 0;
+        dac_phase_increment[i]   = 0;
         active_tones_snapshot[i] = 0.0f;
     }
     active_tones_snapshot_length = 0;
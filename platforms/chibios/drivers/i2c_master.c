@@ -31,6 +31,26 @@
 
 static uint8_t i2c_address;
 
+#if defined(I2C_ASYNC_ENABLE) && I2C_USE_MUTUAL_EXCLUSION != TRUE
+#    error "I2C_ASYNC_ENABLE requires I2C_USE_MUTUAL_EXCLUSION to be enabled in halconf.h"
+#endif
+
+// Serialise transfers when the bus is shared between threads, with RGB_MATRIX_THREADED or the I2C_ASYNC_ENABLE thread
+#if (defined(RGB_MATRIX_THREADED) || defined(I2C_ASYNC_ENABLE)) && I2C_USE_MUTUAL_EXCLUSION == TRUE
+#    define i2c_acquire_bus() i2cAcquireBus(&I2C_DRIVER)
+#    define i2c_release_bus() i2cReleaseBus(&I2C_DRIVER)
+#else
+#    define i2c_acquire_bus()
+#    define i2c_release_bus()
+#endif
+
+#ifdef I2C_ASYNC_ENABLE
+// Blocking transfers wait for queued ones first, so transfers always reach the bus in the order they were issued
+#    define i2c_async_wait() i2c_async_flush()
+#else
+#    define i2c_async_wait()
+#endif
+
 static const I2CConfig i2cconfig = {
 #if defined(USE_I2CV1_CONTRIB)
     I2C1_CLOCK_SPEED,
@@ -81,26 +101,39 @@ __attribute__((weak)) void i2c_init(void) {
 }
 
 i2c_status_t i2c_start(uint8_t address) {
+    i2c_async_wait();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     return I2C_STATUS_SUCCESS;
 }
 
-i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+static i2c_status_t i2c_transmit_unqueued(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_acquire_bus();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, 0, 0, TIME_MS2I(timeout));
+    i2c_release_bus();
     return chibios_to_qmk(&status);
 }
 
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
+    return i2c_transmit_unqueued(address, data, length, timeout);
+}
+
 i2c_status_t i2c_receive(uint8_t address, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
+    i2c_acquire_bus();
     i2c_address = address;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterReceiveTimeout(&I2C_DRIVER, (i2c_address >> 1), data, length, TIME_MS2I(timeout));
+    i2c_release_bus();
     return chibios_to_qmk(&status);
 }
 
 i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
+    i2c_acquire_bus();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
 
@@ -111,10 +144,13 @@ i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t* data,
     complete_packet[0] = regaddr;
 
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), complete_packet, length + 1, 0, 0, TIME_MS2I(timeout));
+    i2c_release_bus();
     return chibios_to_qmk(&status);
 }
 
 i2c_status_t i2c_writeReg16(uint8_t devaddr, uint16_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
+    i2c_acquire_bus();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
 
@@ -126,22 +162,169 @@ i2c_status_t i2c_writeReg16(uint8_t devaddr, uint16_t regaddr, const uint8_t* da
     complete_packet[1] = regaddr & 0xFF;
 
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), complete_packet, length + 2, 0, 0, TIME_MS2I(timeout));
+    i2c_release_bus();
     return chibios_to_qmk(&status);
 }
 
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
+    i2c_acquire_bus();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     msg_t status = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), &regaddr, 1, data, length, TIME_MS2I(timeout));
+    i2c_release_bus();
     return chibios_to_qmk(&status);
 }
 
 i2c_status_t i2c_readReg16(uint8_t devaddr, uint16_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout) {
+    i2c_async_wait();
+    i2c_acquire_bus();
     i2c_address = devaddr;
     i2cStart(&I2C_DRIVER, &i2cconfig);
     uint8_t register_packet[2] = {regaddr >> 8, regaddr & 0xFF};
     msg_t   status             = i2cMasterTransmitTimeout(&I2C_DRIVER, (i2c_address >> 1), register_packet, 2, data, length, TIME_MS2I(timeout));
+    i2c_release_bus();
     return chibios_to_qmk(&status);
 }
 
-void i2c_stop(void) { i2cStop(&I2C_DRIVER); }
+void i2c_stop(void) {
+    i2c_async_wait();
+    i2cStop(&I2C_DRIVER);
+}
+
+#ifdef I2C_ASYNC_ENABLE
+typedef struct {
+    uint8_t              address;
+    uint8_t              length;
+    uint16_t             timeout;
+    i2c_async_callback_t callback;
+    void*                arg;
+    bool                 filled;
+    uint8_t              data[I2C_ASYNC_MAX_LENGTH];
+} i2c_async_transfer_t;
+
+// Slots are reserved by any thread in submission order and drained in the same order by the I2C thread, once every
+// slot before them has been filled
+static i2c_async_transfer_t i2c_async_queue[I2C_ASYNC_QUEUE_SIZE];
+static uint8_t              i2c_async_head;
+static uint8_t              i2c_async_unfilled;  // reserved slots not yet handed to the I2C thread, ending at head
+static uint8_t              i2c_async_tail;
+static uint8_t              i2c_async_pending;
+static semaphore_t          i2c_async_free_slots;
+static semaphore_t          i2c_async_queued;
+static threads_queue_t      i2c_async_idle;
+
+static THD_WORKING_AREA(waI2CAsyncThread, I2C_ASYNC_THREAD_STACK_SIZE);
+static THD_FUNCTION(I2CAsyncThread, arg) {
+    (void)arg;
+    chRegSetThreadName("i2c_async");
+
+    while (true) {
+        chSemWait(&i2c_async_queued);
+
+        // The transfer itself is DMA driven, this thread sleeps until it completes
+        i2c_async_transfer_t* transfer = &i2c_async_queue[i2c_async_tail];
+        i2c_status_t          status   = i2c_transmit_unqueued(transfer->address, transfer->data, transfer->length, transfer->timeout);
+        if (transfer->callback) {
+            transfer->callback(status, transfer->arg);
+        }
+
+        chSysLock();
+        transfer->filled = false;
+        i2c_async_tail   = (i2c_async_tail + 1) % I2C_ASYNC_QUEUE_SIZE;
+        if (--i2c_async_pending == 0) {
+            osalThreadDequeueAllI(&i2c_async_idle, MSG_OK);
+        }
+        chSemSignalI(&i2c_async_free_slots);
+        chSchRescheduleS();
+        chSysUnlock();
+    }
+}
+
+static void i2c_async_init(void) {
+    static bool is_initialised = false;
+    if (!is_initialised) {
+        is_initialised = true;
+
+        chSemObjectInit(&i2c_async_free_slots, I2C_ASYNC_QUEUE_SIZE);
+        chSemObjectInit(&i2c_async_queued, 0);
+        osalThreadQueueObjectInit(&i2c_async_idle);
+        chThdCreateStatic(waI2CAsyncThread, sizeof(waI2CAsyncThread), I2C_ASYNC_THREAD_PRIORITY, I2CAsyncThread, NULL);
+    }
+}
+
+static i2c_status_t i2c_async_submit(uint8_t address, const uint8_t* prefix, uint8_t prefix_length, const uint8_t* data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void* arg) {
+    i2c_async_init();
+
+    // Waits for a free slot if the queue is full
+    chSemWait(&i2c_async_free_slots);
+
+    // The slot is reserved with the system locked so concurrent submitters can't reorder transfers, but filled
+    // afterwards to keep the lock short
+    chSysLock();
+    i2c_async_transfer_t* transfer = &i2c_async_queue[i2c_async_head];
+    i2c_async_head                 = (i2c_async_head + 1) % I2C_ASYNC_QUEUE_SIZE;
+    i2c_async_unfilled++;
+    i2c_async_pending++;
+    chSysUnlock();
+
+    transfer->address  = address;
+    transfer->length   = prefix_length + length;
+    transfer->timeout  = timeout;
+    transfer->callback = callback;
+    transfer->arg      = arg;
+    if (prefix_length) {
+        memcpy(transfer->data, prefix, prefix_length);
+    }
+    memcpy(&transfer->data[prefix_length], data, length);
+
+    // Hand over every slot that is filled now, in order; a slot filled ahead of an earlier one waits for it
+    chSysLock();
+    transfer->filled = true;
+    while (i2c_async_unfilled > 0) {
+        i2c_async_transfer_t* next = &i2c_async_queue[(i2c_async_head + I2C_ASYNC_QUEUE_SIZE - i2c_async_unfilled) % I2C_ASYNC_QUEUE_SIZE];
+        if (!next->filled) {
+            break;
+        }
+        i2c_async_unfilled--;
+        chSemSignalI(&i2c_async_queued);
+    }
+    chSchRescheduleS();
+    chSysUnlock();
+
+    return I2C_STATUS_SUCCESS;
+}
+
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void* arg) {
+    if (length > I2C_ASYNC_MAX_LENGTH) {
+        // Too large to queue, fall back to a blocking transfer
+        i2c_status_t status = i2c_transmit(address, data, length, timeout);
+        if (callback) {
+            callback(status, arg);
+        }
+        return status;
+    }
+    return i2c_async_submit(address, NULL, 0, data, length, timeout, callback, arg);
+}
+
+i2c_status_t i2c_writeReg_async(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void* arg) {
+    if (length + 1 > I2C_ASYNC_MAX_LENGTH) {
+        i2c_status_t status = i2c_writeReg(devaddr, regaddr, data, length, timeout);
+        if (callback) {
+            callback(status, arg);
+        }
+        return status;
+    }
+    return i2c_async_submit(devaddr, &regaddr, 1, data, length, timeout, callback, arg);
+}
+
+bool i2c_async_busy(void) { return i2c_async_pending != 0; }
+
+void i2c_async_flush(void) {
+    chSysLock();
+    if (i2c_async_pending != 0) {
+        osalThreadEnqueueTimeoutS(&i2c_async_idle, TIME_INFINITE);
+    }
+    chSysUnlock();
+}
+#endif
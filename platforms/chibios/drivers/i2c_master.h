@@ -100,3 +100,35 @@ i2c_status_t i2c_writeReg16(uint8_t devaddr, uint16_t regaddr, const uint8_t* da
 i2c_status_t i2c_readReg(uint8_t devaddr, uint8_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout);
 i2c_status_t i2c_readReg16(uint8_t devaddr, uint16_t regaddr, uint8_t* data, uint16_t length, uint16_t timeout);
 void         i2c_stop(void);
+
+#ifdef I2C_ASYNC_ENABLE
+#    ifndef I2C_ASYNC_QUEUE_SIZE
+#        define I2C_ASYNC_QUEUE_SIZE 8
+#    endif
+#    ifndef I2C_ASYNC_MAX_LENGTH
+#        define I2C_ASYNC_MAX_LENGTH 65
+#    endif
+#    ifndef I2C_ASYNC_THREAD_PRIORITY
+#        define I2C_ASYNC_THREAD_PRIORITY (NORMALPRIO + 1)
+#    endif
+#    ifndef I2C_ASYNC_THREAD_STACK_SIZE
+#        define I2C_ASYNC_THREAD_STACK_SIZE 256
+#    endif
+
+#    if I2C_ASYNC_QUEUE_SIZE > UINT8_MAX
+#        error "I2C_ASYNC_QUEUE_SIZE must not exceed 255"
+#    endif
+#    if I2C_ASYNC_MAX_LENGTH > UINT8_MAX
+#        error "I2C_ASYNC_MAX_LENGTH must not exceed 255"
+#    endif
+
+/* Called from the I2C thread once a queued transfer has finished. */
+typedef void (*i2c_async_callback_t)(i2c_status_t status, void* arg);
+
+/* Queue a transfer and return immediately. The data is copied, so the buffer can be reused as soon as the call
+ * returns. Transfers longer than I2C_ASYNC_MAX_LENGTH are sent blocking instead. */
+i2c_status_t i2c_transmit_async(uint8_t address, const uint8_t* data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void* arg);
+i2c_status_t i2c_writeReg_async(uint8_t devaddr, uint8_t regaddr, const uint8_t* data, uint16_t length, uint16_t timeout, i2c_async_callback_t callback, void* arg);
+bool         i2c_async_busy(void);
+void         i2c_async_flush(void);
+#endif
@@ -0,0 +1,462 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * USART split transport built on the ChibiOS UART driver, which moves every
+ * buffer with DMA instead of feeding the peripheral a byte at a time from the
+ * serial queues. Between transfers the driver keeps the receiver running into
+ * its idle buffer and reports each byte through rxchar_cb, which is where the
+ * slave picks up the transaction index and arms the rest of the exchange from
+ * interrupt context.
+ *
+ * In full-duplex mode the master sends the index and its buffer back to back
+ * without waiting for the handshake, so the handshake and the slave's reply
+ * overlap the outgoing data and a transaction costs a single turnaround. In
+ * half-duplex mode our own transmission is echoed back, so the echo is received
+ * into the same DMA buffer in front of the reply and skipped.
+ */
+
+#include "serial_usart.h"
+
+#include <string.h>
+
+#if !defined(SERIAL_USART_DMA_DRIVER)
+#    define SERIAL_USART_DMA_DRIVER UARTD1
+#endif
+
+#if !defined(SERIAL_USART_RESYNC_TIMEOUT)
+#    define SERIAL_USART_RESYNC_TIMEOUT 1  // ms of silence on the line before a new transaction is accepted after an error
+#endif
+
+#if !HAL_USE_UART
+#    error "SERIAL_DRIVER = usart_dma requires HAL_USE_UART to be TRUE in halconf.h"
+#endif
+
+/* Index and buffer, plus the echo of up to two buffers in half-duplex mode. */
+#define USART_DMA_BUFFER_SIZE (2 + 2 * UINT8_MAX)
+
+#define USART_PENDING_TX (1 << 0)
+#define USART_PENDING_RX (1 << 1)
+
+static void usart_txend2_cb(UARTDriver* uartp);
+static void usart_rxend_cb(UARTDriver* uartp);
+static void usart_rxchar_cb(UARTDriver* uartp, uint16_t c);
+static void usart_rxerr_cb(UARTDriver* uartp, uartflags_t e);
+
+static UARTConfig uart_config = {
+    .txend2_cb = usart_txend2_cb,
+    .rxend_cb  = usart_rxend_cb,
+    .rxchar_cb = usart_rxchar_cb,
+    .rxerr_cb  = usart_rxerr_cb,
+    .speed     = (SERIAL_USART_SPEED),
+    .cr1       = (SERIAL_USART_CR1),
+    .cr2       = (SERIAL_USART_CR2),
+#if !defined(SERIAL_USART_FULL_DUPLEX)
+    .cr3 = ((SERIAL_USART_CR3) | USART_CR3_HDSEL) /* activate half-duplex mode */
+#else
+    .cr3 = (SERIAL_USART_CR3)
+#endif
+};
+
+static UARTDriver* uart_driver = &SERIAL_USART_DMA_DRIVER;
+
+static uint8_t usart_tx_buffer[USART_DMA_BUFFER_SIZE];
+static uint8_t usart_rx_buffer[USART_DMA_BUFFER_SIZE];
+
+static thread_reference_t   usart_thread = NULL;
+static volatile uint8_t     usart_pending;
+static volatile uartflags_t usart_errors;
+static volatile uint16_t    usart_rx_offset;
+static volatile uint16_t    usart_idle_chars;
+
+static bool    is_slave         = false;
+static bool    slave_idle       = false;
+static uint8_t slave_sstd_index = 0;
+
+static inline bool react_to_transactions(void);
+static inline int  initiate_transaction(uint8_t sstd_index);
+
+/**
+ * @brief Start a DMA transfer of tx_size bytes from the transmit buffer while
+ * receiving rx_size bytes into the receive buffer.
+ *
+ * @return true Transfer started.
+ * @return false Transfer does not fit into the DMA buffers.
+ */
+static bool usart_start_transfer_i(size_t tx_size, size_t rx_size) {
+#if !defined(SERIAL_USART_FULL_DUPLEX)
+    /* The echo of our own transmission arrives in front of the reply. */
+    size_t rx_total = tx_size + rx_size;
+#else
+    size_t rx_total = rx_size;
+#endif
+
+    if (rx_total > sizeof(usart_rx_buffer)) {
+        return false;
+    }
+
+    usart_errors    = 0;
+    usart_rx_offset = rx_total - rx_size;
+    usart_pending   = (rx_total ? USART_PENDING_RX : 0) | (tx_size ? USART_PENDING_TX : 0);
+
+    /* Arm the receiver first, so no byte of the reply or the echo can be missed. */
+    if (rx_total) {
+        uartStartReceiveI(uart_driver, rx_total, usart_rx_buffer);
+    }
+    if (tx_size) {
+        uartStartSendI(uart_driver, tx_size, usart_tx_buffer);
+    }
+    return true;
+}
+
+/**
+ * @brief Block until the running transfer has completed.
+ *
+ * @return true Transfer success.
+ * @return false Transfer timed out or a receive error occurred.
+ */
+static bool usart_wait_transfer(sysinterval_t timeout) {
+    msg_t msg = MSG_OK;
+
+    osalSysLock();
+    if (usart_pending) {
+        msg = osalThreadSuspendTimeoutS(&usart_thread, timeout);
+    }
+    bool success = msg == MSG_OK && !usart_pending && !usart_errors;
+    osalSysUnlock();
+
+    return success;
+}
+
+/**
+ * @brief Blocking transfer with timeout.
+ */
+static bool usart_transfer(size_t tx_size, size_t rx_size) {
+    osalSysLock();
+    bool started = usart_start_transfer_i(tx_size, rx_size);
+    osalSysUnlock();
+
+    return started && usart_wait_transfer(TIME_MS2I(SERIAL_USART_TIMEOUT));
+}
+
+/**
+ * @brief Abort the running transfer and wait until the line has been silent
+ * for SERIAL_USART_RESYNC_TIMEOUT, so that the remains of a failed
+ * transaction are not mistaken for the start of the next one.
+ */
+static void usart_resync(void) {
+    osalSysLock();
+    uartStopSendI(uart_driver);
+    uartStopReceiveI(uart_driver);
+    usart_pending = 0;
+    osalSysUnlock();
+
+    uint16_t idle_chars;
+    do {
+        idle_chars = usart_idle_chars;
+        chThdSleepMilliseconds(SERIAL_USART_RESYNC_TIMEOUT);
+    } while (idle_chars != usart_idle_chars);
+}
+
+static void usart_complete_i(uint8_t done) {
+    usart_pending &= ~done;
+    if (!usart_pending) {
+        osalThreadResumeI(&usart_thread, MSG_OK);
+    }
+}
+
+/**
+ * @brief Transmission of the last byte has physically completed.
+ */
+static void usart_txend2_cb(UARTDriver* uartp) {
+    (void)uartp;
+
+    osalSysLockFromISR();
+    usart_complete_i(USART_PENDING_TX);
+    osalSysUnlockFromISR();
+}
+
+/**
+ * @brief Receive DMA transfer has completed.
+ */
+static void usart_rxend_cb(UARTDriver* uartp) {
+    (void)uartp;
+
+    osalSysLockFromISR();
+    usart_complete_i(USART_PENDING_RX);
+    osalSysUnlockFromISR();
+}
+
+/**
+ * @brief Framing, noise, parity and overrun errors fail the running transfer
+ * right away, instead of leaving it to time out.
+ */
+static void usart_rxerr_cb(UARTDriver* uartp, uartflags_t e) {
+    (void)uartp;
+
+    osalSysLockFromISR();
+    if (usart_pending) {
+        usart_errors |= e;
+        osalThreadResumeI(&usart_thread, MSG_RESET);
+    }
+    osalSysUnlockFromISR();
+}
+
+/**
+ * @brief A byte arrived while no receive transfer was running. On an idle
+ * slave this is the transaction index sent by the master, anything else is
+ * only counted to detect activity on the line.
+ */
+static void usart_rxchar_cb(UARTDriver* uartp, uint16_t c) {
+    (void)uartp;
+
+    osalSysLockFromISR();
+    usart_idle_chars++;
+
+    if (is_slave && slave_idle && c < NUM_TOTAL_TRANSACTIONS && split_transaction_table[c].status) {
+        split_transaction_desc_t* trans = &split_transaction_table[c];
+
+        /* Send back the handshake which is XORed as a simple checksum, while
+         * already receiving the transaction buffer from the master. */
+        usart_tx_buffer[0] = c ^ HANDSHAKE_MAGIC;
+        if (usart_start_transfer_i(1, trans->initiator2target_buffer_size)) {
+            slave_idle       = false;
+            slave_sstd_index = c;
+            osalThreadResumeI(&usart_thread, MSG_OK);
+        }
+    }
+    osalSysUnlockFromISR();
+}
+
+#if !defined(SERIAL_USART_FULL_DUPLEX)
+
+/**
+ * @brief Initiate pins for USART peripheral. Half-duplex configuration.
+ */
+__attribute__((weak)) void usart_init(void) {
+#    if defined(MCU_STM32)
+#        if defined(USE_GPIOV1)
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE_OPENDRAIN);
+#        else
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_TX_PAL_MODE) | PAL_OUTPUT_TYPE_OPENDRAIN | PAL_OUTPUT_SPEED_HIGHEST);
+#        endif
+
+#        if defined(USART_REMAP)
+    USART_REMAP;
+#        endif
+#    else
+#        pragma message "usart_init: MCU Familiy not supported by default, please supply your own init code by implementing usart_init() in your keyboard files."
+#    endif
+}
+
+#else
+
+/**
+ * @brief Initiate pins for USART peripheral. Full-duplex configuration.
+ */
+__attribute__((weak)) void usart_init(void) {
+#    if defined(MCU_STM32)
+#        if defined(USE_GPIOV1)
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE_PUSHPULL);
+    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_INPUT);
+#        else
+    palSetLineMode(SERIAL_USART_TX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_TX_PAL_MODE) | PAL_OUTPUT_TYPE_PUSHPULL | PAL_OUTPUT_SPEED_HIGHEST);
+    palSetLineMode(SERIAL_USART_RX_PIN, PAL_MODE_ALTERNATE(SERIAL_USART_RX_PAL_MODE) | PAL_OUTPUT_TYPE_PUSHPULL | PAL_OUTPUT_SPEED_HIGHEST);
+#        endif
+
+#        if defined(USART_REMAP)
+    USART_REMAP;
+#        endif
+#    else
+#        pragma message "usart_init: MCU Familiy not supported by default, please supply your own init code by implementing usart_init() in your keyboard files."
+#    endif
+}
+
+#endif
+
+/**
+ * @brief Overridable master specific initializations.
+ */
+__attribute__((weak, nonnull)) void usart_master_init(UARTDriver** driver) {
+    (void)driver;
+    usart_init();
+}
+
+/**
+ * @brief Overridable slave specific initializations.
+ */
+__attribute__((weak, nonnull)) void usart_slave_init(UARTDriver** driver) {
+    (void)driver;
+    usart_init();
+}
+
+/**
+ * @brief This thread runs on the slave and completes transactions which were
+ * started from the receive interrupt.
+ */
+static THD_WORKING_AREA(waSlaveThread, 1024);
+static THD_FUNCTION(SlaveThread, arg) {
+    (void)arg;
+    chRegSetThreadName("usart_dma");
+
+    while (true) {
+        if (!react_to_transactions()) {
+            /* Drop the remains of the failed transaction and wait for the line to settle. */
+            usart_resync();
+        }
+    }
+}
+
+/**
+ * @brief Slave specific initializations.
+ */
+void soft_serial_target_init(void) {
+    usart_slave_init(&uart_driver);
+
+    is_slave = true;
+    uartStart(uart_driver, &uart_config);
+
+    /* Start transport thread. */
+    chThdCreateStatic(waSlaveThread, sizeof(waSlaveThread), HIGHPRIO, SlaveThread, NULL);
+}
+
+/**
+ * @brief React to transactions started by the master.
+ */
+static inline bool react_to_transactions(void) {
+    /* Wait until the receive interrupt has picked up a transaction for us. */
+    osalSysLock();
+    slave_idle = true;
+    osalThreadSuspendS(&usart_thread);
+    osalSysUnlock();
+
+    split_transaction_desc_t* trans = &split_transaction_table[slave_sstd_index];
+
+    /* Wait for the handshake to go out and the transaction buffer to come in. */
+    if (!usart_wait_transfer(TIME_MS2I(SERIAL_USART_TIMEOUT))) {
+        *trans->status = TRANSACTION_DATA_ERROR;
+        return false;
+    }
+
+    if (trans->initiator2target_buffer_size) {
+        memcpy(split_trans_initiator2target_buffer(trans), usart_rx_buffer + usart_rx_offset, trans->initiator2target_buffer_size);
+    }
+
+    /* Allow any slave processing to occur. */
+    if (trans->slave_callback) {
+        trans->slave_callback(trans->initiator2target_buffer_size, split_trans_initiator2target_buffer(trans), trans->target2initiator_buffer_size, split_trans_target2initiator_buffer(trans));
+    }
+
+    /* Send transaction buffer to the master. If this transaction requires it. */
+    if (trans->target2initiator_buffer_size) {
+        memcpy(usart_tx_buffer, split_trans_target2initiator_buffer(trans), trans->target2initiator_buffer_size);
+        if (!usart_transfer(trans->target2initiator_buffer_size, 0)) {
+            *trans->status = TRANSACTION_DATA_ERROR;
+            return false;
+        }
+    }
+
+    *trans->status = TRANSACTION_ACCEPTED;
+    return true;
+}
+
+/**
+ * @brief Master specific initializations.
+ */
+void soft_serial_initiator_init(void) {
+    usart_master_init(&uart_driver);
+
+#if defined(MCU_STM32) && defined(SERIAL_USART_PIN_SWAP)
+    uart_config.cr2 |= USART_CR2_SWAP;  // master has swapped TX/RX pins
+#endif
+
+    uartStart(uart_driver, &uart_config);
+}
+
+/**
+ * @brief Start transaction from the master half to the slave half.
+ *
+ * @param index Transaction Table index of the transaction to start.
+ * @return int TRANSACTION_NO_RESPONSE in case of Timeout.
+ *             TRANSACTION_TYPE_ERROR in case of invalid transaction index.
+ *             TRANSACTION_END in case of success.
+ */
+int soft_serial_transaction(int index) {
+    int result = initiate_transaction((uint8_t)index);
+    if (result == TRANSACTION_NO_RESPONSE) {
+        usart_resync();
+    }
+    return result;
+}
+
+/**
+ * @brief Initiate transaction to slave half.
+ */
+static inline int initiate_transaction(uint8_t sstd_index) {
+    /* Sanity check that we are actually starting a valid transaction. */
+    if (sstd_index >= NUM_TOTAL_TRANSACTIONS) {
+        dprintln("USART: Illegal transaction Id.");
+        return TRANSACTION_TYPE_ERROR;
+    }
+
+    split_transaction_desc_t* trans = &split_transaction_table[sstd_index];
+
+    /* Transaction is not registered. Abort. */
+    if (!trans->status) {
+        dprintln("USART: Transaction not registered.");
+        return TRANSACTION_TYPE_ERROR;
+    }
+
+    /* Send transaction table index to the slave, which doubles as basic handshake token. */
+    usart_tx_buffer[0] = sstd_index;
+    size_t tx_size     = 1;
+
+#if defined(SERIAL_USART_FULL_DUPLEX)
+    /* The slave starts receiving the transaction buffer as soon as it has seen the index,
+     * so the buffer follows right away and the handshake comes back while it is still being sent. */
+    memcpy(usart_tx_buffer + tx_size, split_trans_initiator2target_buffer(trans), trans->initiator2target_buffer_size);
+    tx_size += trans->initiator2target_buffer_size;
+    size_t rx_size = 1 + trans->target2initiator_buffer_size;
+#else
+    /* The handshake is always read back first so that we can error out correctly,
+     * the reply of transactions without a transaction buffer to send is received along with it. */
+    size_t rx_size = 1 + (trans->initiator2target_buffer_size ? 0 : trans->target2initiator_buffer_size);
+#endif
+
+    if (!usart_transfer(tx_size, rx_size) || usart_rx_buffer[usart_rx_offset] != (sstd_index ^ HANDSHAKE_MAGIC)) {
+        dprintln("USART: Handshake failed.");
+        return TRANSACTION_NO_RESPONSE;
+    }
+    const uint8_t* reply = usart_rx_buffer + usart_rx_offset + 1;
+
+#if !defined(SERIAL_USART_FULL_DUPLEX)
+    /* Send transaction buffer to the slave, receiving the reply in the same transfer. */
+    if (trans->initiator2target_buffer_size) {
+        memcpy(usart_tx_buffer, split_trans_initiator2target_buffer(trans), trans->initiator2target_buffer_size);
+        if (!usart_transfer(trans->initiator2target_buffer_size, trans->target2initiator_buffer_size)) {
+            dprintln("USART: Transfer failed.");
+            return TRANSACTION_NO_RESPONSE;
+        }
+        reply = usart_rx_buffer + usart_rx_offset;
+    }
+#endif
+
+    if (trans->target2initiator_buffer_size) {
+        memcpy(split_trans_target2initiator_buffer(trans), reply, trans->target2initiator_buffer_size);
+    }
+
+    return TRANSACTION_END;
+}
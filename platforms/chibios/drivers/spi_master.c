@@ -20,6 +20,12 @@
 
 static pin_t currentSlavePin = NO_PIN;
 
+// With RGB_MATRIX_THREADED the bus is shared with the render thread, so it is held from spi_start() to spi_stop()
+#if defined(RGB_MATRIX_THREADED) && SPI_USE_MUTUAL_EXCLUSION == TRUE
+#    define SPI_SHARED
+static thread_t *spi_owner = NULL;
+#endif
+
 #if defined(K20x) || defined(KL2x)
 static SPIConfig spiConfig = {NULL, 0, 0, 0};
 #else
@@ -49,7 +55,7 @@ __attribute__((weak)) void spi_init(void) {
     }
 }
 
-bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
+static bool spi_start_unlocked(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
     if (currentSlavePin != NO_PIN || slavePin == NO_PIN) {
         return false;
     }
@@ -227,6 +233,25 @@ bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
     return true;
 }
 
+bool spi_start(pin_t slavePin, bool lsbFirst, uint8_t mode, uint16_t divisor) {
+#ifdef SPI_SHARED
+    // Already started by this thread, the bus mutex isn't recursive so don't wait for it
+    if (spi_owner == chThdGetSelfX()) {
+        return false;
+    }
+    // Wait for other threads to finish with the bus
+    spiAcquireBus(&SPI_DRIVER);
+    if (!spi_start_unlocked(slavePin, lsbFirst, mode, divisor)) {
+        spiReleaseBus(&SPI_DRIVER);
+        return false;
+    }
+    spi_owner = chThdGetSelfX();
+    return true;
+#else
+    return spi_start_unlocked(slavePin, lsbFirst, mode, divisor);
+#endif
+}
+
 spi_status_t spi_write(uint8_t data) {
     uint8_t rxData;
     spiExchange(&SPI_DRIVER, 1, &data, &rxData);
@@ -256,5 +281,9 @@ void spi_stop(void) {
         spiUnselect(&SPI_DRIVER);
         spiStop(&SPI_DRIVER);
         currentSlavePin = NO_PIN;
+#ifdef SPI_SHARED
+        spi_owner = NULL;
+        spiReleaseBus(&SPI_DRIVER);
+#endif
     }
 }
@@ -78,9 +78,15 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
     }
 
     // this code is very time dependent, so we need to disable interrupts
+#ifndef WS2812_BITBANG_LOCK_PER_LED
     chSysLock();
+#endif
 
-    for (uint8_t i = 0; i < leds; i++) {
+    for (uint16_t i = 0; i < leds; i++) {
+#ifdef WS2812_BITBANG_LOCK_PER_LED
+        // interrupts are only serviced in the low gap between two LEDs
+        chSysLock();
+#endif
         // WS2812 protocol dictates grb order
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
         sendByte(ledarray[i].g);
@@ -98,10 +104,16 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
 
 #ifdef RGBW
         sendByte(ledarray[i].w);
+#endif
+#ifdef WS2812_BITBANG_LOCK_PER_LED
+        chSysUnlock();
 #endif
     }
 
-    wait_ns(WS2812_RES);
-
+#ifndef WS2812_BITBANG_LOCK_PER_LED
     chSysUnlock();
+#endif
+
+    // the line is held low for the reset gap, being interrupted only makes it longer
+    wait_ns(WS2812_RES);
 }
@@ -79,45 +79,67 @@
 #define DATA_SIZE (BYTES_FOR_LED * RGBLED_NUM)
 #define RESET_SIZE (1000 * WS2812_TRST_US / (2 * WS2812_TIMING))
 #define PREAMBLE_SIZE 4
+#define TXBUF_SIZE (PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE)
 
-static uint8_t txbuf[PREAMBLE_SIZE + DATA_SIZE + RESET_SIZE] = {0};
+// Async sends are double buffered: the next frame is encoded into one buffer while the DMA clocks out the other
+#if defined(WS2812_SPI_USE_CIRCULAR_BUFFER) || defined(WS2812_SPI_SYNC)
+#    define TXBUF_COUNT 1
+#else
+#    define WS2812_SPI_DOUBLE_BUFFER
+#    define TXBUF_COUNT 2
+#endif
+
+static uint8_t txbuf[TXBUF_COUNT][TXBUF_SIZE] = {0};
+static uint8_t txbuf_back                     = 0;
+
+#ifdef WS2812_SPI_DOUBLE_BUFFER
+// Taken while a frame is being clocked out, signalled from the SPI completion interrupt
+static binary_semaphore_t frame_done;
+
+static void ws2812_spi_end_cb(SPIDriver* spip) {
+    (void)spip;
+    chSysLockFromISR();
+    chBSemSignalI(&frame_done);
+    chSysUnlockFromISR();
+}
+#    define WS2812_SPI_END_CB ws2812_spi_end_cb
+#else
+#    define WS2812_SPI_END_CB NULL
+#endif
 
 /*
  * As the trick here is to use the SPI to send a huge pattern of 0 and 1 to
  * the ws2812b protocol, we use this helper function to translate bytes into
  * 0s and 1s for the LED (with the appropriate timing).
+ * Each SPI byte carries two LED bits, MSB first: 0b1000 for a 0 and 0b1110 for a 1.
  */
-static uint8_t get_protocol_eq(uint8_t data, int pos) {
-    uint8_t eq = 0;
-    if (data & (1 << (2 * (3 - pos))))
-        eq = 0b1110;
-    else
-        eq = 0b1000;
-    if (data & (2 << (2 * (3 - pos))))
-        eq += 0b11100000;
-    else
-        eq += 0b10000000;
-    return eq;
+static const uint8_t protocol_eq[4] = {0b10001000, 0b10001110, 0b11101000, 0b11101110};
+
+static inline void set_led_byte(uint8_t* dst, uint8_t data) {
+    dst[0] = protocol_eq[(data >> 6) & 0b11];
+    dst[1] = protocol_eq[(data >> 4) & 0b11];
+    dst[2] = protocol_eq[(data >> 2) & 0b11];
+    dst[3] = protocol_eq[data & 0b11];
 }
 
-static void set_led_color_rgb(LED_TYPE color, int pos) {
-    uint8_t* tx_start = &txbuf[PREAMBLE_SIZE];
+static void set_led_color_rgb(uint8_t* tx_start, LED_TYPE color, int pos) {
+    uint8_t* tx_led = &tx_start[PREAMBLE_SIZE + BYTES_FOR_LED * pos];
 
 #if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    set_led_byte(tx_led, color.g);
+    set_led_byte(tx_led + BYTES_FOR_LED_BYTE, color.r);
+    set_led_byte(tx_led + BYTES_FOR_LED_BYTE * 2, color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.r, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.b, j);
+    set_led_byte(tx_led, color.r);
+    set_led_byte(tx_led + BYTES_FOR_LED_BYTE, color.g);
+    set_led_byte(tx_led + BYTES_FOR_LED_BYTE * 2, color.b);
 #elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + j] = get_protocol_eq(color.b, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE + j] = get_protocol_eq(color.g, j);
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 2 + j] = get_protocol_eq(color.r, j);
+    set_led_byte(tx_led, color.b);
+    set_led_byte(tx_led + BYTES_FOR_LED_BYTE, color.g);
+    set_led_byte(tx_led + BYTES_FOR_LED_BYTE * 2, color.r);
 #endif
 #ifdef RGBW
-    for (int j = 0; j < 4; j++) tx_start[BYTES_FOR_LED * pos + BYTES_FOR_LED_BYTE * 4 + j] = get_protocol_eq(color.w, j);
+    set_led_byte(tx_led + BYTES_FOR_LED_BYTE * 3, color.w);
 #endif
 }
 
@@ -128,14 +150,18 @@ void ws2812_init(void) {
     palSetLineMode(WS2812_SPI_SCK_PIN, WS2812_SCK_OUTPUT_MODE);
 #endif  // WS2812_SPI_SCK_PIN
 
+#ifdef WS2812_SPI_DOUBLE_BUFFER
+    chBSemObjectInit(&frame_done, false);
+#endif
+
     // TODO: more dynamic baudrate
-    static const SPIConfig spicfg = {WS2812_SPI_BUFFER_MODE, NULL, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN), WS2812_SPI_DIVISOR_CR1_BR_X};
+    static const SPIConfig spicfg = {WS2812_SPI_BUFFER_MODE, WS2812_SPI_END_CB, PAL_PORT(RGB_DI_PIN), PAL_PAD(RGB_DI_PIN), WS2812_SPI_DIVISOR_CR1_BR_X};
 
     spiAcquireBus(&WS2812_SPI);     /* Acquire ownership of the bus.    */
     spiStart(&WS2812_SPI, &spicfg); /* Setup transfer parameters.       */
     spiSelect(&WS2812_SPI);         /* Slave Select assertion.          */
 #ifdef WS2812_SPI_USE_CIRCULAR_BUFFER
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    spiStartSend(&WS2812_SPI, TXBUF_SIZE, txbuf[0]);
 #endif
 }
 
@@ -146,17 +172,20 @@ void ws2812_setleds(LED_TYPE* ledarray, uint16_t leds) {
         s_init = true;
     }
 
-    for (uint8_t i = 0; i < leds; i++) {
-        set_led_color_rgb(ledarray[i], i);
+    uint8_t* tx = txbuf[txbuf_back];
+    for (uint16_t i = 0; i < leds; i++) {
+        set_led_color_rgb(tx, ledarray[i], i);
     }
 
-    // Send async - each led takes ~0.03ms, 50 leds ~1.5ms, animations flushing faster than send will cause issues.
-    // Instead spiSend can be used to send synchronously (or the thread logic can be added back).
+    // Each led takes ~0.03ms, 100 leds ~3ms. The async send only waits here if the previous
+    // frame is still being clocked out, so effects render the next frame during the transfer.
 #ifndef WS2812_SPI_USE_CIRCULAR_BUFFER
 #    ifdef WS2812_SPI_SYNC
-    spiSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    spiSend(&WS2812_SPI, TXBUF_SIZE, tx);
 #    else
-    spiStartSend(&WS2812_SPI, sizeof(txbuf) / sizeof(txbuf[0]), txbuf);
+    chBSemWait(&frame_done);
+    spiStartSend(&WS2812_SPI, TXBUF_SIZE, tx);
+    txbuf_back ^= 1;
 #    endif
 #endif
 }
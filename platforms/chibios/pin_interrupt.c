@@ -0,0 +1,54 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ch.h>
+#include <hal.h>
+
+#include "pin_interrupt.h"
+
+#if !defined(PAL_USE_CALLBACKS) || PAL_USE_CALLBACKS != TRUE
+#    error "PAL_USE_CALLBACKS must be set to TRUE in halconf.h for pin interrupts"
+#endif
+
+#define MAX_INTERRUPT_PADS 32
+
+// Most MCUs share each external interrupt line between the same pad number on every port, so only one
+// pin per pad number can be armed at a time, whichever feature it was armed for.
+static ioline_t armed_lines[MAX_INTERRUPT_PADS];
+static uint32_t armed_pads = 0;
+
+bool pin_interrupt_enable(pin_t pin, pin_interrupt_edge_t edge, pin_interrupt_callback_t callback, void *arg) {
+    uint8_t pad = PAL_PAD(pin);
+    if (pad >= MAX_INTERRUPT_PADS || (armed_pads & (1UL << pad))) {
+        return false;
+    }
+
+    armed_lines[pad] = pin;
+    armed_pads |= 1UL << pad;
+    palEnableLineEvent(pin, edge == PIN_INTERRUPT_BOTH_EDGES ? PAL_EVENT_MODE_BOTH_EDGES : PAL_EVENT_MODE_FALLING_EDGE);
+    palSetLineCallback(pin, callback, arg);
+    return true;
+}
+
+void pin_interrupt_disable(pin_t pin) {
+    uint8_t pad = PAL_PAD(pin);
+    if (pad >= MAX_INTERRUPT_PADS || !(armed_pads & (1UL << pad)) || armed_lines[pad] != pin) {
+        return;
+    }
+
+    palDisableLineEvent(pin);
+    armed_pads &= ~(1UL << pad);
+}
@@ -0,0 +1,62 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ch.h>
+#include <hal.h>
+
+#include "pin_wakeup.h"
+#include "pin_interrupt.h"
+#include "timer.h"
+
+static thread_reference_t waiting_thread = NULL;
+static volatile bool      edge_seen      = false;
+static volatile systime_t edge_systime;
+
+void pin_wakeup_signal_from_isr(void) {
+    chSysLockFromISR();
+    if (!edge_seen) {
+        edge_seen    = true;
+        edge_systime = chVTGetSystemTimeX();
+    }
+    chThdResumeI(&waiting_thread, MSG_OK);
+    chSysUnlockFromISR();
+}
+
+static void pin_wakeup_callback(void *arg) { pin_wakeup_signal_from_isr(); }
+
+bool pin_wakeup_enable(pin_t pin) { return pin_interrupt_enable(pin, PIN_INTERRUPT_FALLING_EDGE, pin_wakeup_callback, NULL); }
+
+void pin_wakeup_disable(pin_t pin) {
+    pin_interrupt_disable(pin);
+    edge_seen = false;
+}
+
+bool pin_wakeup_wait(uint32_t timeout_ms, uint32_t *edge_time) {
+    chSysLock();
+    if (!edge_seen) {
+        chThdSuspendTimeoutS(&waiting_thread, TIME_MS2I(timeout_ms));
+    }
+    bool      woken   = edge_seen;
+    systime_t systime = edge_systime;
+    edge_seen         = false;
+    chSysUnlock();
+
+    if (woken) {
+        // timer_read32() can't be called from the interrupt, so work back from how long ago the edge was
+        *edge_time = timer_read32() - TIME_I2MS(chVTTimeElapsedSinceX(systime));
+    }
+    return woken;
+}
@@ -0,0 +1,39 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gpio.h"
+
+typedef void (*pin_interrupt_callback_t)(void *arg);
+
+typedef enum {
+    PIN_INTERRUPT_FALLING_EDGE,
+    PIN_INTERRUPT_BOTH_EDGES,
+} pin_interrupt_edge_t;
+
+/** \brief Calls callback from interrupt context on the given edges of an input pin
+ *
+ * Interrupt lines are shared by every user of this API, so a pin can only be armed while no other pin
+ * holds its line. Returns false if the pin cannot raise an interrupt, in which case the caller needs to
+ * poll it.
+ */
+bool pin_interrupt_enable(pin_t pin, pin_interrupt_edge_t edge, pin_interrupt_callback_t callback, void *arg);
+
+/** \brief Disarms a pin armed with pin_interrupt_enable()
+ */
+void pin_interrupt_disable(pin_t pin);
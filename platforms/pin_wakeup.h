@@ -0,0 +1,43 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gpio.h"
+
+/** \brief Arms a falling edge wakeup on an input pin
+ *
+ * Returns false if the pin cannot wake the MCU, in which case the caller needs to poll it.
+ */
+bool pin_wakeup_enable(pin_t pin);
+
+/** \brief Disarms a pin armed with pin_wakeup_enable()
+ */
+void pin_wakeup_disable(pin_t pin);
+
+/** \brief Ends a pin_wakeup_wait() in progress, as if an armed pin had seen an edge
+ *
+ * For other pin interrupts that need the main loop to run, must be called from interrupt context.
+ */
+void pin_wakeup_signal_from_isr(void);
+
+/** \brief Sleeps until an armed pin sees a falling edge, or until timeout_ms has passed
+ *
+ * May also return early on other wakeup sources, so callers should check their pins afterwards.
+ * Returns true if woken by an edge, with the time of the edge stored in edge_time.
+ */
+bool pin_wakeup_wait(uint32_t timeout_ms, uint32_t *edge_time);
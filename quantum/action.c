@@ -419,6 +419,7 @@ void process_action(keyrecord_t *record, action_t action) {
                     } else {
                         if (tap_count > 0) {
                             dprint("MODS_TAP: Tap: unregister_code\n");
+                            flush_keyboard_report_batch();
                             if (action.layer_tap.code == KC_CAPS_LOCK) {
                                 wait_ms(TAP_HOLD_CAPS_DELAY);
                             } else {
@@ -618,6 +619,7 @@ void process_action(keyrecord_t *record, action_t action) {
                     } else {
                         if (tap_count > 0) {
                             dprint("KEYMAP_TAP_KEY: Tap: unregister_code\n");
+                            flush_keyboard_report_batch();
                             if (action.layer_tap.code == KC_CAPS_LOCK) {
                                 wait_ms(TAP_HOLD_CAPS_DELAY);
                             } else {
@@ -700,6 +702,7 @@ void process_action(keyrecord_t *record, action_t action) {
                         if (event.pressed) {
                             register_code(action.swap.code);
                         } else {
+                            flush_keyboard_report_batch();
                             wait_ms(TAP_CODE_DELAY);
                             unregister_code(action.swap.code);
                             *record = (keyrecord_t){};  // hack: reset tap mode
@@ -806,6 +809,7 @@ void register_code(uint8_t code) {
 #    endif
         add_key(KC_CAPS_LOCK);
         send_keyboard_report();
+        flush_keyboard_report_batch();
         wait_ms(100);
         del_key(KC_CAPS_LOCK);
         send_keyboard_report();
@@ -817,6 +821,7 @@ void register_code(uint8_t code) {
 #    endif
         add_key(KC_NUM_LOCK);
         send_keyboard_report();
+        flush_keyboard_report_batch();
         wait_ms(100);
         del_key(KC_NUM_LOCK);
         send_keyboard_report();
@@ -828,6 +833,7 @@ void register_code(uint8_t code) {
 #    endif
         add_key(KC_SCROLL_LOCK);
         send_keyboard_report();
+        flush_keyboard_report_batch();
         wait_ms(100);
         del_key(KC_SCROLL_LOCK);
         send_keyboard_report();
@@ -957,6 +963,7 @@ void unregister_code(uint8_t code) {
  */
 void tap_code_delay(uint8_t code, uint16_t delay) {
     register_code(code);
+    flush_keyboard_report_batch();
     for (uint16_t i = delay; i > 0; i--) {
         wait_ms(1);
     }
@@ -10,6 +10,10 @@
 #    include "nodebug.h"
 #endif
 
+#if !defined(NO_ACTION_LAYER) && defined(RESOLVED_LAYER_CACHE)
+static void sync_resolved_layers(void);
+#endif
+
 /** \brief Default Layer State
  */
 layer_state_t default_layer_state = 0;
@@ -38,6 +42,9 @@ static void default_layer_state_set(layer_state_t state) {
     default_layer_state = state;
     default_layer_debug();
     debug("\n");
+#if !defined(NO_ACTION_LAYER) && defined(RESOLVED_LAYER_CACHE)
+    sync_resolved_layers();
+#endif
 #ifdef STRICT_LAYER_RELEASE
     clear_keyboard_but_mods();  // To avoid stuck keys
 #else
@@ -104,6 +111,9 @@ void layer_state_set(layer_state_t state) {
     layer_state = state;
     layer_debug();
     dprintln();
+#    ifdef RESOLVED_LAYER_CACHE
+    sync_resolved_layers();
+#    endif
 #    ifdef STRICT_LAYER_RELEASE
     clear_keyboard_but_mods();  // To avoid stuck keys
 #    else
@@ -246,16 +256,15 @@ action_t store_or_get_action(bool pressed, keypos_t key) {
 #endif
 }
 
-/** \brief Layer switch get layer
+#ifndef NO_ACTION_LAYER
+/** \brief Resolve layer
  *
- * Gets the layer based on key info
+ * Finds the topmost layer in the given state with a non-transparent action for the key
  */
-uint8_t layer_switch_get_layer(keypos_t key) {
-#ifndef NO_ACTION_LAYER
+static uint8_t resolve_layer(keypos_t key, layer_state_t layers) {
     action_t action;
     action.code = ACTION_TRANSPARENT;
 
-    layer_state_t layers = layer_state | default_layer_state;
     /* check top layer first */
     for (int8_t i = MAX_LAYER - 1; i >= 0; i--) {
         if (layers & ((layer_state_t)1 << i)) {
@@ -267,6 +276,84 @@ uint8_t layer_switch_get_layer(keypos_t key) {
     }
     /* fall back to layer 0 */
     return 0;
+}
+#endif
+
+#if !defined(NO_ACTION_LAYER) && defined(RESOLVED_LAYER_CACHE)
+/** \brief resolved layer cache
+ *
+ * Topmost non-transparent layer of every key, for the layer state stored in resolved_layers_state
+ */
+static uint8_t       resolved_layers[MATRIX_ROWS][MATRIX_COLS];
+static layer_state_t resolved_layers_state = 0;
+static bool          resolved_layers_valid = false;
+
+/** \brief Update resolved layer cache
+ *
+ * Brings the cache up to date with the given layer state. Only keys that can be affected
+ * by the change are resolved again: keys whose layer was turned off, and keys that may now
+ * be shadowed by a newly enabled layer above the one they currently resolve to.
+ */
+static void update_resolved_layers(layer_state_t layers) {
+    const layer_state_t added   = layers & ~resolved_layers_state;
+    const layer_state_t removed = resolved_layers_state & ~layers;
+    const uint8_t       highest = added ? get_highest_layer(added) : 0;
+
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            keypos_t key   = (keypos_t){.row = row, .col = col};
+            uint8_t  layer = resolved_layers[row][col];
+
+            if (!resolved_layers_valid || (removed & ((layer_state_t)1 << layer))) {
+                layer = resolve_layer(key, layers);
+            } else if (highest > layer) {
+                /* only newly enabled layers above the current one can shadow it */
+                for (uint8_t i = highest; i > layer; i--) {
+                    if ((added & ((layer_state_t)1 << i)) && action_for_key(i, key).code != ACTION_TRANSPARENT) {
+                        layer = i;
+                        break;
+                    }
+                }
+            }
+            resolved_layers[row][col] = layer;
+        }
+    }
+
+    resolved_layers_state = layers;
+    resolved_layers_valid = true;
+}
+
+/** \brief Sync resolved layer cache
+ *
+ * Updates the cache if the layer state changed since it was last built
+ */
+static void sync_resolved_layers(void) {
+    layer_state_t layers = layer_state | default_layer_state;
+    if (!resolved_layers_valid || layers != resolved_layers_state) {
+        update_resolved_layers(layers);
+    }
+}
+
+/** \brief Invalidate resolved layer cache
+ *
+ * Must be called whenever the keymap contents change at runtime, e.g. through dynamic keymap edits
+ */
+void resolved_layer_cache_invalidate(void) { resolved_layers_valid = false; }
+#endif
+
+/** \brief Layer switch get layer
+ *
+ * Gets the layer based on key info
+ */
+uint8_t layer_switch_get_layer(keypos_t key) {
+#ifndef NO_ACTION_LAYER
+#    ifdef RESOLVED_LAYER_CACHE
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        sync_resolved_layers();
+        return resolved_layers[key.row][key.col];
+    }
+#    endif
+    return resolve_layer(key, layer_state | default_layer_state);
 #else
     return get_highest_layer(default_layer_state);
 #endif
@@ -132,6 +132,13 @@ layer_state_t layer_state_set_kb(layer_state_t state);
 #    define layer_state_set_user(state) (void)state
 #endif
 
+/* resolved layer cache */
+#if !defined(NO_ACTION_LAYER) && defined(RESOLVED_LAYER_CACHE)
+void resolved_layer_cache_invalidate(void);
+#else
+#    define resolved_layer_cache_invalidate()
+#endif
+
 /* pressed actions cache */
 #if !defined(NO_ACTION_LAYER) && !defined(STRICT_LAYER_RELEASE)
 
@@ -64,6 +64,7 @@ void action_macro_play(const macro_t *macro_p) {
                 dprintf("WAIT(%u)\n", macro);
                 {
                     uint8_t ms = macro;
+                    flush_keyboard_report_batch();
                     while (ms--) wait_ms(1);
                 }
                 break;
@@ -86,6 +87,7 @@ void action_macro_play(const macro_t *macro_p) {
         // interval
         {
             uint8_t ms = interval;
+            if (ms) flush_keyboard_report_batch();
             while (ms--) wait_ms(1);
         }
     }
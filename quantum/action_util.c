@@ -21,6 +21,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_layer.h"
 #include "timer.h"
 #include "keycode_config.h"
+#ifdef KEYBOARD_EVENT_BATCHING
+#    include <string.h>
+#endif
 
 extern keymap_config_t keymap_config;
 
@@ -216,6 +219,79 @@ bool is_oneshot_enabled(void) { return keymap_config.oneshot_disable; }
 
 #endif
 
+#ifdef KEYBOARD_EVENT_BATCHING
+static bool              report_batch_active  = false;
+static bool              batch_report_pending = false;
+static report_keyboard_t batch_sent_report;
+static report_keyboard_t batch_pending_report;
+
+/** \brief Check whether replacing the pending report would hide a transition from the host
+ *
+ * A transition is hidden when something that already changed since the last sent report
+ * changes again, e.g. a key pressed and released within the same batch.
+ * NKRO reports are compared per bit, 6KRO slots per byte.
+ */
+static bool batched_report_conflicts(void) {
+    const uint8_t *sent    = (const uint8_t *)&batch_sent_report;
+    const uint8_t *pending = (const uint8_t *)&batch_pending_report;
+    const uint8_t *next    = (const uint8_t *)keyboard_report;
+    for (uint8_t i = 0; i < sizeof(report_keyboard_t); i++) {
+#    ifdef NKRO_ENABLE
+        if (keyboard_protocol && keymap_config.nkro) {
+            if ((pending[i] ^ sent[i]) & (next[i] ^ pending[i])) return true;
+            continue;
+        }
+#    endif
+        if (pending[i] != sent[i] && next[i] != pending[i]) return true;
+    }
+    return false;
+}
+
+static void flush_batched_report(void) {
+    memcpy(&batch_sent_report, &batch_pending_report, sizeof(report_keyboard_t));
+    batch_report_pending = false;
+    host_keyboard_send(&batch_sent_report);
+}
+
+/** \brief Hold back a keyboard report until the end of the batch
+ *
+ * Intermediate states are merged into one report, unless doing so would drop a press or release.
+ */
+static void queue_batched_report(void) {
+    if (batch_report_pending && batched_report_conflicts()) {
+        flush_batched_report();
+    }
+    memcpy(&batch_pending_report, keyboard_report, sizeof(report_keyboard_t));
+    batch_report_pending = memcmp(&batch_pending_report, &batch_sent_report, sizeof(report_keyboard_t)) != 0;
+}
+
+/** \brief Start coalescing keyboard reports
+ *
+ * Calls to send_keyboard_report() are held back until end_keyboard_report_batch().
+ */
+void begin_keyboard_report_batch(void) { report_batch_active = true; }
+
+/** \brief Stop coalescing keyboard reports
+ *
+ * Sends the coalesced report, if it differs from the one the host last received.
+ */
+void end_keyboard_report_batch(void) {
+    report_batch_active = false;
+    flush_keyboard_report_batch();
+}
+
+/** \brief Send the coalesced report now, without ending the batch
+ *
+ * Must be called before waiting in the middle of an event, e.g. between the press and
+ * release of a tap, otherwise the host would only see the report after the wait.
+ */
+void flush_keyboard_report_batch(void) {
+    if (batch_report_pending) {
+        flush_batched_report();
+    }
+}
+#endif
+
 /** \brief Send keyboard report
  *
  * FIXME: needs doc
@@ -247,6 +323,13 @@ void send_keyboard_report(void) {
     keyboard_report->mods |= weak_override_mods;
 #endif
 
+#ifdef KEYBOARD_EVENT_BATCHING
+    if (report_batch_active) {
+        queue_batched_report();
+        return;
+    }
+    memcpy(&batch_sent_report, keyboard_report, sizeof(report_keyboard_t));
+#endif
     host_keyboard_send(keyboard_report);
 }
 
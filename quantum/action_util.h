@@ -28,6 +28,14 @@ extern report_keyboard_t *keyboard_report;
 
 void send_keyboard_report(void);
 
+#ifdef KEYBOARD_EVENT_BATCHING
+void begin_keyboard_report_batch(void);
+void end_keyboard_report_batch(void);
+void flush_keyboard_report_batch(void);
+#else
+static inline void flush_keyboard_report_batch(void) {}
+#endif
+
 /* key */
 inline void add_key(uint8_t key) { add_key_to_report(keyboard_report, key); }
 
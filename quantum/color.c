@@ -18,82 +18,66 @@
 #include "led_tables.h"
 #include "progmem.h"
 
-RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
-    RGB      rgb;
-    uint8_t  region, remainder, p, q, t;
-    uint16_t h, s, v;
+enum { HSV_CHANNEL_V, HSV_CHANNEL_P, HSV_CHANNEL_Q, HSV_CHANNEL_T };
 
-    if (hsv.s == 0) {
-#ifdef USE_CIE1931_CURVE
-        if (use_cie) {
-            rgb.r = rgb.g = rgb.b = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-        } else {
-            rgb.r = hsv.v;
-            rgb.g = hsv.v;
-            rgb.b = hsv.v;
-        }
-#else
-        rgb.r = hsv.v;
-        rgb.g = hsv.v;
-        rgb.b = hsv.v;
-#endif
+// Which of v, p, q and t end up in r, g and b for each sixth of the hue circle.
+// Region 6 is only reached by h = 255 and wraps around to region 0.
+static const uint8_t hsv_region_map[7][3] = {
+    {HSV_CHANNEL_V, HSV_CHANNEL_T, HSV_CHANNEL_P}, {HSV_CHANNEL_Q, HSV_CHANNEL_V, HSV_CHANNEL_P}, {HSV_CHANNEL_P, HSV_CHANNEL_V, HSV_CHANNEL_T}, {HSV_CHANNEL_P, HSV_CHANNEL_Q, HSV_CHANNEL_V}, {HSV_CHANNEL_T, HSV_CHANNEL_P, HSV_CHANNEL_V}, {HSV_CHANNEL_V, HSV_CHANNEL_P, HSV_CHANNEL_Q}, {HSV_CHANNEL_V, HSV_CHANNEL_T, HSV_CHANNEL_P},
+};
+
+static inline RGB hsv_to_rgb_kernel(uint8_t h, uint8_t s, uint8_t v) {
+    RGB     rgb;
+    uint8_t channel[4];
+
+    if (s == 0) {
+        rgb.r = v;
+        rgb.g = v;
+        rgb.b = v;
         return rgb;
     }
 
-    h = hsv.h;
-    s = hsv.s;
-#ifdef USE_CIE1931_CURVE
-    if (use_cie) {
-        v = pgm_read_byte(&CIE1931_CURVE[hsv.v]);
-    } else {
-        v = hsv.v;
-    }
+    // Same result as h * 6 / 255 for every h, without the division
+    uint8_t region    = ((uint32_t)(h * 6 + 1) * 257) >> 16;
+    uint8_t remainder = (h * 2 - region * 85) * 3;
+
+    channel[HSV_CHANNEL_V] = v;
+    channel[HSV_CHANNEL_P] = (v * (255 - s)) >> 8;
+#if defined(__AVR__)
+    channel[HSV_CHANNEL_Q] = (v * (255 - ((s * remainder) >> 8))) >> 8;
+    channel[HSV_CHANNEL_T] = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
 #else
-    v = hsv.v;
+    // q and t are worked out side by side in the two 16 bit halves of a 32 bit word,
+    // the products of two bytes never carry over into the upper half.
+    uint32_t lanes         = s * (remainder | ((uint32_t)(255 - remainder) << 16));
+    lanes                  = v * (0x00FF00FF - ((lanes >> 8) & 0x00FF00FF));
+    channel[HSV_CHANNEL_Q] = lanes >> 8;
+    channel[HSV_CHANNEL_T] = lanes >> 24;
 #endif
 
-    region    = h * 6 / 255;
-    remainder = (h * 2 - region * 85) * 3;
-
-    p = (v * (255 - s)) >> 8;
-    q = (v * (255 - ((s * remainder) >> 8))) >> 8;
-    t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+    rgb.r = channel[hsv_region_map[region][0]];
+    rgb.g = channel[hsv_region_map[region][1]];
+    rgb.b = channel[hsv_region_map[region][2]];
+    return rgb;
+}
 
-    switch (region) {
-        case 6:
-        case 0:
-            rgb.r = v;
-            rgb.g = t;
-            rgb.b = p;
-            break;
-        case 1:
-            rgb.r = q;
-            rgb.g = v;
-            rgb.b = p;
-            break;
-        case 2:
-            rgb.r = p;
-            rgb.g = v;
-            rgb.b = t;
-            break;
-        case 3:
-            rgb.r = p;
-            rgb.g = q;
-            rgb.b = v;
-            break;
-        case 4:
-            rgb.r = t;
-            rgb.g = p;
-            rgb.b = v;
-            break;
-        default:
-            rgb.r = v;
-            rgb.g = p;
-            rgb.b = q;
-            break;
+RGB hsv_to_rgb_impl(HSV hsv, bool use_cie) {
+#ifdef USE_CIE1931_CURVE
+    if (use_cie) {
+        return hsv_to_rgb_kernel(hsv.h, hsv.s, pgm_read_byte(&CIE1931_CURVE[hsv.v]));
     }
+#endif
+    return hsv_to_rgb_kernel(hsv.h, hsv.s, hsv.v);
+}
 
-    return rgb;
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+#ifdef USE_CIE1931_CURVE
+        rgb[i] = hsv_to_rgb_kernel(hsv[i].h, hsv[i].s, pgm_read_byte(&CIE1931_CURVE[hsv[i].v]));
+#else
+        rgb[i] = hsv_to_rgb_kernel(hsv[i].h, hsv[i].s, hsv[i].v);
+#endif
+    }
 }
 
 RGB hsv_to_rgb(HSV hsv) {
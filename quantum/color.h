@@ -145,6 +145,8 @@ typedef struct PACKED {
 
 RGB hsv_to_rgb(HSV hsv);
 RGB hsv_to_rgb_nocie(HSV hsv);
+// Converts a whole array at once, applying the CIE1931 curve like hsv_to_rgb()
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count);
 #ifdef RGBW
 void convert_rgb_to_rgbw(LED_TYPE *led);
 #endif
@@ -0,0 +1,173 @@
+/*
+Copyright 2017 Alex Ong<the.onga@gmail.com>
+Copyright 2020 Andrei Purdea<andrei@purdea.ro>
+Copyright 2021 Simon Arlott
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+Symmetric per-key algorithm using bit-sliced vertical counters. Behaves the same as sym_defer_pk, but
+instead of an 8-bit counter per key, each bit of the counters is stored as a matrix_row_t plane, so a
+whole row of counters is updated with a handful of bitwise operations and no heap allocation.
+When no state changes have occured for DEBOUNCE milliseconds, we push the state.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include "quantum.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+// Maximum debounce: 255ms
+#if DEBOUNCE > UINT8_MAX
+#    undef DEBOUNCE
+#    define DEBOUNCE UINT8_MAX
+#endif
+
+// Number of bit planes needed to hold a counter value of DEBOUNCE
+#if DEBOUNCE < 2
+#    define DEBOUNCE_COUNTER_BITS 1
+#elif DEBOUNCE < 4
+#    define DEBOUNCE_COUNTER_BITS 2
+#elif DEBOUNCE < 8
+#    define DEBOUNCE_COUNTER_BITS 3
+#elif DEBOUNCE < 16
+#    define DEBOUNCE_COUNTER_BITS 4
+#elif DEBOUNCE < 32
+#    define DEBOUNCE_COUNTER_BITS 5
+#elif DEBOUNCE < 64
+#    define DEBOUNCE_COUNTER_BITS 6
+#elif DEBOUNCE < 128
+#    define DEBOUNCE_COUNTER_BITS 7
+#else
+#    define DEBOUNCE_COUNTER_BITS 8
+#endif
+
+#if DEBOUNCE > 0
+// Bit b of the counter for key (row, col) is bit col of debounce_counters[row][b]. A counter of zero means elapsed.
+static matrix_row_t debounce_counters[MATRIX_ROWS][DEBOUNCE_COUNTER_BITS];
+static fast_timer_t last_time;
+static bool         counters_need_update;
+
+static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time);
+static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows);
+
+// we use num_rows rather than MATRIX_ROWS to support split keyboards
+void debounce_init(uint8_t num_rows) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        for (uint8_t bit = 0; bit < DEBOUNCE_COUNTER_BITS; bit++) {
+            debounce_counters[row][bit] = 0;
+        }
+    }
+    counters_need_update = false;
+}
+
+void debounce_free(void) {}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    bool updated_last = false;
+
+    if (counters_need_update) {
+        fast_timer_t now          = timer_read_fast();
+        fast_timer_t elapsed_time = TIMER_DIFF_FAST(now, last_time);
+
+        last_time    = now;
+        updated_last = true;
+        if (elapsed_time > UINT8_MAX) {
+            elapsed_time = UINT8_MAX;
+        }
+
+        if (elapsed_time > 0) {
+            update_debounce_counters_and_transfer_if_expired(raw, cooked, num_rows, elapsed_time);
+        }
+    }
+
+    if (changed) {
+        if (!updated_last) {
+            last_time = timer_read_fast();
+        }
+
+        start_debounce_counters(raw, cooked, num_rows);
+    }
+}
+
+static void update_debounce_counters_and_transfer_if_expired(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, uint8_t elapsed_time) {
+    counters_need_update = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t *counter = debounce_counters[row];
+        matrix_row_t  active  = 0;
+        for (uint8_t bit = 0; bit < DEBOUNCE_COUNTER_BITS; bit++) {
+            active |= counter[bit];
+        }
+        if (!active) {
+            continue;
+        }
+
+        // Subtract elapsed_time from every counter in the row at once, one bit plane at a time
+        matrix_row_t diff[DEBOUNCE_COUNTER_BITS];
+        matrix_row_t borrow   = 0;
+        matrix_row_t non_zero = 0;
+        for (uint8_t bit = 0; bit < DEBOUNCE_COUNTER_BITS; bit++) {
+            matrix_row_t subtrahend = (elapsed_time & (1 << bit)) ? (matrix_row_t)~0 : 0;
+            diff[bit]               = counter[bit] ^ subtrahend ^ borrow;
+            borrow                  = (~counter[bit] & subtrahend) | (~(counter[bit] ^ subtrahend) & borrow);
+            non_zero |= diff[bit];
+        }
+        if (elapsed_time >> DEBOUNCE_COUNTER_BITS) {
+            // elapsed_time is larger than any counter can hold
+            borrow = (matrix_row_t)~0;
+        }
+
+        // Counters that reached zero or underflowed have expired
+        matrix_row_t expired = active & (borrow | ~non_zero);
+        matrix_row_t running = active & ~expired;
+        for (uint8_t bit = 0; bit < DEBOUNCE_COUNTER_BITS; bit++) {
+            counter[bit] = diff[bit] & running;
+        }
+
+        cooked[row] = (cooked[row] & ~expired) | (raw[row] & expired);
+        if (running) {
+            counters_need_update = true;
+        }
+    }
+}
+
+static void start_debounce_counters(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t *counter = debounce_counters[row];
+        matrix_row_t  delta   = raw[row] ^ cooked[row];
+        matrix_row_t  active  = 0;
+        for (uint8_t bit = 0; bit < DEBOUNCE_COUNTER_BITS; bit++) {
+            active |= counter[bit];
+        }
+
+        // Keys that changed start counting down from DEBOUNCE, unless they are already counting;
+        // keys that match the debounced state again stop counting.
+        matrix_row_t start = delta & ~active;
+        for (uint8_t bit = 0; bit < DEBOUNCE_COUNTER_BITS; bit++) {
+            if (DEBOUNCE & (1 << bit)) {
+                counter[bit] |= start;
+            }
+            counter[bit] &= delta;
+        }
+        if (start) {
+            counters_need_update = true;
+        }
+    }
+}
+
+bool debounce_active(void) { return true; }
+#else
+#    include "none.c"
+#endif
@@ -5,43 +5,152 @@
 #include <timer.h>
 #include <deferred_exec.h>
 
-#ifndef MAX_DEFERRED_EXECUTORS
-#    define MAX_DEFERRED_EXECUTORS 8
+// Executors are kept in a fixed pool of slots. Pending executors are additionally ordered by trigger time in a binary
+// min-heap, so only the earliest one needs checking on each task invocation. Tokens encode the slot they refer to,
+// which makes looking up an executor from its token constant-time.
+
+#if MAX_DEFERRED_EXECUTORS > 255
+typedef uint16_t executor_index_t;
+#else
+typedef uint8_t executor_index_t;
 #endif
 
+#define NO_EXECUTOR ((executor_index_t)-1)
+#define MAX_DEFERRED_TOKEN ((deferred_token)-1)
+
+typedef enum {
+    EXECUTOR_FREE = 0,  // unused, in the free list
+    EXECUTOR_QUEUED,    // waiting in the heap
+    EXECUTOR_RUNNING,   // callback currently being invoked
+    EXECUTOR_REQUEUE,   // invoked during this task pass, waiting to be pushed back onto the heap
+    EXECUTOR_CANCELLED  // cancelled while running or waiting for requeue, released at the end of the task pass
+} executor_state_t;
+
 typedef struct deferred_executor_t {
     deferred_token         token;
+    uint8_t                state;
+    executor_index_t       heap_index;
+    executor_index_t       next;  // link for the free list or the requeue list
     uint32_t               trigger_time;
     deferred_exec_callback callback;
     void *                 cb_arg;
 } deferred_executor_t;
 
-static deferred_token      current_token                     = 0;
 static uint32_t            last_deferred_exec_check          = 0;
 static deferred_executor_t executors[MAX_DEFERRED_EXECUTORS] = {0};
+static executor_index_t    heap[MAX_DEFERRED_EXECUTORS];
+static uint16_t            heap_size      = 0;
+static uint16_t            executors_used = 0;  // slots at or above this index have never been allocated
+static executor_index_t    free_list      = NO_EXECUTOR;
 
-static inline bool token_can_be_used(deferred_token token) {
-    if (token == INVALID_DEFERRED_TOKEN) {
-        return false;
-    }
-    for (int i = 0; i < MAX_DEFERRED_EXECUTORS; ++i) {
-        if (executors[i].token == token) {
-            return false;
+static inline bool executor_before(executor_index_t a, executor_index_t b) {
+    // Wraparound-safe comparison of trigger times
+    return ((int32_t)TIMER_DIFF_32(executors[a].trigger_time, executors[b].trigger_time)) < 0;
+}
+
+static inline void heap_place(uint16_t pos, executor_index_t slot) {
+    heap[pos]                  = slot;
+    executors[slot].heap_index = pos;
+}
+
+static void heap_sift_up(uint16_t pos) {
+    executor_index_t slot = heap[pos];
+    while (pos > 0) {
+        uint16_t parent = (pos - 1) / 2;
+        if (!executor_before(slot, heap[parent])) {
+            break;
         }
+        heap_place(pos, heap[parent]);
+        pos = parent;
     }
-    return true;
+    heap_place(pos, slot);
 }
 
-static inline deferred_token allocate_token(void) {
-    deferred_token first = ++current_token;
-    while (!token_can_be_used(current_token)) {
-        ++current_token;
-        if (current_token == first) {
-            // If we've looped back around to the first, everything is already allocated (yikes!). Need to exit with a failure.
-            return INVALID_DEFERRED_TOKEN;
+static void heap_sift_down(uint16_t pos) {
+    executor_index_t slot = heap[pos];
+    while (true) {
+        uint16_t child = 2 * pos + 1;
+        if (child >= heap_size) {
+            break;
         }
+        if (child + 1 < heap_size && executor_before(heap[child + 1], heap[child])) {
+            ++child;
+        }
+        if (!executor_before(heap[child], slot)) {
+            break;
+        }
+        heap_place(pos, heap[child]);
+        pos = child;
+    }
+    heap_place(pos, slot);
+}
+
+static void heap_push(executor_index_t slot) {
+    executors[slot].state = EXECUTOR_QUEUED;
+    heap_place(heap_size++, slot);
+    heap_sift_up(heap_size - 1);
+}
+
+static void heap_remove(executor_index_t slot) {
+    uint16_t pos = executors[slot].heap_index;
+    --heap_size;
+    if (pos != heap_size) {
+        // Move the last element into the hole, then restore the heap property in whichever direction is needed
+        executor_index_t moved = heap[heap_size];
+        heap_place(pos, moved);
+        heap_sift_up(pos);
+        heap_sift_down(executors[moved].heap_index);
+    }
+}
+
+static inline executor_index_t slot_for_token(deferred_token token) {
+    if (token == INVALID_DEFERRED_TOKEN) {
+        return NO_EXECUTOR;
+    }
+    executor_index_t slot = (token - 1) % MAX_DEFERRED_EXECUTORS;
+    if (executors[slot].token != token) {
+        return NO_EXECUTOR;
+    }
+    switch (executors[slot].state) {
+        case EXECUTOR_QUEUED:
+        case EXECUTOR_RUNNING:
+        case EXECUTOR_REQUEUE:
+            return slot;
+        default:
+            return NO_EXECUTOR;
+    }
+}
+
+static inline executor_index_t allocate_executor(void) {
+    executor_index_t slot;
+    if (free_list != NO_EXECUTOR) {
+        slot      = free_list;
+        free_list = executors[slot].next;
+    } else if (executors_used < MAX_DEFERRED_EXECUTORS) {
+        slot = executors_used++;
+    } else {
+        return NO_EXECUTOR;
     }
-    return current_token;
+
+    // Each reuse of a slot hands out a different token, cycling through every token value that maps onto the slot
+    deferred_token token = executors[slot].token;
+    if (token == INVALID_DEFERRED_TOKEN || token > MAX_DEFERRED_TOKEN - MAX_DEFERRED_EXECUTORS) {
+        token = slot + 1;
+    } else {
+        token += MAX_DEFERRED_EXECUTORS;
+    }
+    executors[slot].token = token;
+    return slot;
+}
+
+static inline void release_executor(executor_index_t slot) {
+    deferred_executor_t *entry = &executors[slot];
+    entry->state               = EXECUTOR_FREE;
+    entry->trigger_time        = 0;
+    entry->callback            = NULL;
+    entry->cb_arg              = NULL;
+    entry->next                = free_list;
+    free_list                  = slot;
 }
 
 deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) {
@@ -50,70 +159,68 @@ deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, vo
         return INVALID_DEFERRED_TOKEN;
     }
 
-    // Find an unused slot and claim it
-    for (int i = 0; i < MAX_DEFERRED_EXECUTORS; ++i) {
-        deferred_executor_t *entry = &executors[i];
-        if (entry->token == INVALID_DEFERRED_TOKEN) {
-            // Work out the new token value, dropping out if none were available
-            deferred_token token = allocate_token();
-            if (token == INVALID_DEFERRED_TOKEN) {
-                return false;
-            }
-
-            // Set up the executor table entry
-            entry->token        = current_token;
-            entry->trigger_time = timer_read32() + delay_ms;
-            entry->callback     = callback;
-            entry->cb_arg       = cb_arg;
-            return current_token;
-        }
+    // Claim an unused slot, dropping out if none were available
+    executor_index_t slot = allocate_executor();
+    if (slot == NO_EXECUTOR) {
+        return INVALID_DEFERRED_TOKEN;
     }
 
-    // None available
-    return INVALID_DEFERRED_TOKEN;
+    // Set up the executor table entry
+    deferred_executor_t *entry = &executors[slot];
+    entry->trigger_time        = timer_read32() + delay_ms;
+    entry->callback            = callback;
+    entry->cb_arg              = cb_arg;
+    heap_push(slot);
+    return entry->token;
 }
 
 bool extend_deferred_exec(deferred_token token, uint32_t delay_ms) {
-    // Ignore queueing if it's a zero-time delay, or the token is not valid
-    if (delay_ms == 0 || token == INVALID_DEFERRED_TOKEN) {
+    // Ignore queueing if it's a zero-time delay
+    if (delay_ms == 0) {
         return false;
     }
 
     // Find the entry corresponding to the token
-    for (int i = 0; i < MAX_DEFERRED_EXECUTORS; ++i) {
-        deferred_executor_t *entry = &executors[i];
-        if (entry->token == token) {
-            // Found it, extend the delay
-            entry->trigger_time = timer_read32() + delay_ms;
-            return true;
-        }
+    executor_index_t slot = slot_for_token(token);
+    if (slot == NO_EXECUTOR) {
+        return false;
     }
 
-    // Not found
-    return false;
+    // Found it, extend the delay
+    executors[slot].trigger_time = timer_read32() + delay_ms;
+    if (executors[slot].state == EXECUTOR_QUEUED) {
+        heap_sift_up(executors[slot].heap_index);
+        heap_sift_down(executors[slot].heap_index);
+    }
+    return true;
 }
 
 bool cancel_deferred_exec(deferred_token token) {
-    // Ignore request if the token is not valid
-    if (token == INVALID_DEFERRED_TOKEN) {
+    // Find the entry corresponding to the token
+    executor_index_t slot = slot_for_token(token);
+    if (slot == NO_EXECUTOR) {
         return false;
     }
 
-    // Find the entry corresponding to the token
-    for (int i = 0; i < MAX_DEFERRED_EXECUTORS; ++i) {
-        deferred_executor_t *entry = &executors[i];
-        if (entry->token == token) {
-            // Found it, cancel and clear the table entry
-            entry->token        = INVALID_DEFERRED_TOKEN;
-            entry->trigger_time = 0;
-            entry->callback     = NULL;
-            entry->cb_arg       = NULL;
-            return true;
-        }
+    // Found it, cancel and clear the table entry
+    if (executors[slot].state == EXECUTOR_QUEUED) {
+        heap_remove(slot);
+        release_executor(slot);
+    } else {
+        // Currently being processed by deferred_exec_task(), which releases it once it's done
+        executors[slot].state    = EXECUTOR_CANCELLED;
+        executors[slot].callback = NULL;
+        executors[slot].cb_arg   = NULL;
     }
+    return true;
+}
 
-    // Not found
-    return false;
+bool deferred_exec_next_deadline(uint32_t *trigger_time) {
+    if (heap_size == 0) {
+        return false;
+    }
+    *trigger_time = executors[heap[0]].trigger_time;
+    return true;
 }
 
 void deferred_exec_task(void) {
@@ -123,29 +230,43 @@ void deferred_exec_task(void) {
     if (((int32_t)TIMER_DIFF_32(now, last_deferred_exec_check)) > 0) {
         last_deferred_exec_check = now;
 
-        // Run through each of the executors
-        for (int i = 0; i < MAX_DEFERRED_EXECUTORS; ++i) {
-            deferred_executor_t *entry = &executors[i];
-
-            // Check if we're supposed to execute this entry
-            if (entry->token != INVALID_DEFERRED_TOKEN && ((int32_t)TIMER_DIFF_32(entry->trigger_time, now)) <= 0) {
-                // Invoke the callback and work work out if we should be requeued
-                uint32_t delay_ms = entry->callback(entry->trigger_time, entry->cb_arg);
-
-                // Update the trigger time if we have to repeat, otherwise clear it out
-                if (delay_ms > 0) {
-                    // Intentionally add just the delay to the existing trigger time -- this ensures the next
-                    // invocation is with respect to the previous trigger, rather than when it got to execution. Under
-                    // normal circumstances this won't cause issue, but if another executor is invoked that takes a
-                    // considerable length of time, then this ensures best-effort timing between invocations.
-                    entry->trigger_time += delay_ms;
-                } else {
-                    // If it was zero, then the callback is cancelling repeated execution. Free up the slot.
-                    entry->token        = INVALID_DEFERRED_TOKEN;
-                    entry->trigger_time = 0;
-                    entry->callback     = NULL;
-                    entry->cb_arg       = NULL;
-                }
+        // Executors that need repeating are held back until all due executors have been invoked, so each one runs at
+        // most once per pass even if it has fallen behind.
+        executor_index_t requeue = NO_EXECUTOR;
+
+        // Run through each of the due executors, earliest first
+        while (heap_size > 0 && ((int32_t)TIMER_DIFF_32(executors[heap[0]].trigger_time, now)) <= 0) {
+            executor_index_t     slot  = heap[0];
+            deferred_executor_t *entry = &executors[slot];
+            heap_remove(slot);
+            entry->state = EXECUTOR_RUNNING;
+
+            // Invoke the callback and work work out if we should be requeued
+            uint32_t delay_ms = entry->callback(entry->trigger_time, entry->cb_arg);
+
+            // Update the trigger time if we have to repeat, otherwise clear it out
+            if (entry->state == EXECUTOR_RUNNING && delay_ms > 0) {
+                // Intentionally add just the delay to the existing trigger time -- this ensures the next
+                // invocation is with respect to the previous trigger, rather than when it got to execution. Under
+                // normal circumstances this won't cause issue, but if another executor is invoked that takes a
+                // considerable length of time, then this ensures best-effort timing between invocations.
+                entry->trigger_time += delay_ms;
+                entry->state = EXECUTOR_REQUEUE;
+                entry->next  = requeue;
+                requeue      = slot;
+            } else {
+                // If it was zero, then the callback is cancelling repeated execution. Free up the slot.
+                release_executor(slot);
+            }
+        }
+
+        while (requeue != NO_EXECUTOR) {
+            executor_index_t slot = requeue;
+            requeue               = executors[slot].next;
+            if (executors[slot].state == EXECUTOR_REQUEUE) {
+                heap_push(slot);
+            } else {
+                release_executor(slot);
             }
         }
     }
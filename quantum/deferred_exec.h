@@ -6,8 +6,16 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#ifndef MAX_DEFERRED_EXECUTORS
+#    define MAX_DEFERRED_EXECUTORS 8
+#endif
+
 // A token that can be used to cancel an existing deferred execution.
+#if MAX_DEFERRED_EXECUTORS > 255
+typedef uint16_t deferred_token;
+#else
 typedef uint8_t deferred_token;
+#endif
 #define INVALID_DEFERRED_TOKEN 0
 
 // Callback to execute.
@@ -34,5 +42,10 @@ bool extend_deferred_exec(deferred_token token, uint32_t delay_ms);
 //  -- Return value: if the token was found, and the executor was cancelled
 bool cancel_deferred_exec(deferred_token token);
 
+// Retrieves the trigger time of the earliest pending deferred execution, allowing the main loop to idle until then.
+//  -- Parameter trigger_time: receives the trigger time -- equivalent time-space as timer_read32()
+//  -- Return value: if any deferred execution is pending
+bool deferred_exec_next_deadline(uint32_t *trigger_time);
+
 // Forward declaration for the main loop in order to execute any deferred executors. Should not be invoked by keyboard/user code.
 void deferred_exec_task(void);
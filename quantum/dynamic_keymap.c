@@ -61,9 +61,23 @@
 #    endif
 #endif
 
+#define DYNAMIC_KEYMAP_EEPROM_SIZE (DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2)
+
 // Dynamic macro starts after dynamic keymaps
 #ifndef DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR
-#    define DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR (DYNAMIC_KEYMAP_EEPROM_ADDR + (DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2))
+#    define DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR (DYNAMIC_KEYMAP_EEPROM_ADDR + DYNAMIC_KEYMAP_EEPROM_SIZE)
+#endif
+
+// Keymaps up to this many bytes are mirrored in RAM, so keycode lookups don't
+// have to go to the EEPROM (which may be on an external I2C/SPI chip).
+// How much RAM can be spared depends on the MCU and the rest of the firmware,
+// so the mirror is off unless the keyboard opts in.
+#ifndef DYNAMIC_KEYMAP_RAM_MIRROR_MAX_SIZE
+#    define DYNAMIC_KEYMAP_RAM_MIRROR_MAX_SIZE 0
+#endif
+
+#if DYNAMIC_KEYMAP_EEPROM_SIZE <= DYNAMIC_KEYMAP_RAM_MIRROR_MAX_SIZE
+#    define DYNAMIC_KEYMAP_USE_RAM_MIRROR
 #endif
 
 // Sanity check that dynamic keymaps fit in available EEPROM
@@ -81,6 +95,45 @@
 #    define DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE (DYNAMIC_KEYMAP_EEPROM_MAX_ADDR - DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + 1)
 #endif
 
+#ifdef DYNAMIC_KEYMAP_USE_RAM_MIRROR
+// Written through on every change, the EEPROM stays authoritative across reboots.
+static uint16_t dynamic_keymap_mirror[DYNAMIC_KEYMAP_LAYER_COUNT][MATRIX_ROWS][MATRIX_COLS];
+static bool     dynamic_keymap_mirror_loaded = false;
+
+static void dynamic_keymap_mirror_load(void) {
+    // Read the whole keymap in one go, then convert from the big endian EEPROM layout in place
+    uint8_t *bytes = (uint8_t *)dynamic_keymap_mirror;
+    eeprom_read_block(bytes, (void *)DYNAMIC_KEYMAP_EEPROM_ADDR, DYNAMIC_KEYMAP_EEPROM_SIZE);
+    uint16_t *keycode = &dynamic_keymap_mirror[0][0][0];
+    for (uint16_t i = 0; i < DYNAMIC_KEYMAP_EEPROM_SIZE; i += 2) {
+        *keycode++ = (bytes[i] << 8) | bytes[i + 1];
+    }
+    dynamic_keymap_mirror_loaded = true;
+}
+
+static inline uint8_t dynamic_keymap_mirror_get_byte(uint16_t offset) {
+    uint16_t keycode = (&dynamic_keymap_mirror[0][0][0])[offset / 2];
+    return (offset & 1) ? (keycode & 0xFF) : (keycode >> 8);
+}
+
+static inline void dynamic_keymap_mirror_set_byte(uint16_t offset, uint8_t value) {
+    uint16_t *keycode = &(&dynamic_keymap_mirror[0][0][0])[offset / 2];
+    if (offset & 1) {
+        *keycode = (*keycode & 0xFF00) | value;
+    } else {
+        *keycode = (*keycode & 0x00FF) | (value << 8);
+    }
+}
+#endif
+
+void dynamic_keymap_init(void) {
+#ifdef DYNAMIC_KEYMAP_USE_RAM_MIRROR
+    if (!dynamic_keymap_mirror_loaded) {
+        dynamic_keymap_mirror_load();
+    }
+#endif
+}
+
 uint8_t dynamic_keymap_get_layer_count(void) { return DYNAMIC_KEYMAP_LAYER_COUNT; }
 
 void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t column) {
@@ -89,18 +142,31 @@ void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t c
 }
 
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+    // Positions come straight from the host, don't read outside the keymap
+    if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || row >= MATRIX_ROWS || column >= MATRIX_COLS) return KC_NO;
+#ifdef DYNAMIC_KEYMAP_USE_RAM_MIRROR
+    dynamic_keymap_init();
+    return dynamic_keymap_mirror[layer][row][column];
+#else
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
     uint16_t keycode = eeprom_read_byte(address) << 8;
     keycode |= eeprom_read_byte(address + 1);
     return keycode;
+#endif
 }
 
 void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode) {
+    if (layer >= DYNAMIC_KEYMAP_LAYER_COUNT || row >= MATRIX_ROWS || column >= MATRIX_COLS) return;
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
     eeprom_update_byte(address, (uint8_t)(keycode >> 8));
     eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+#ifdef DYNAMIC_KEYMAP_USE_RAM_MIRROR
+    dynamic_keymap_init();
+    dynamic_keymap_mirror[layer][row][column] = keycode;
+#endif
+    resolved_layer_cache_invalidate();
 }
 
 void dynamic_keymap_reset(void) {
@@ -117,12 +183,19 @@ void dynamic_keymap_reset(void) {
 }
 
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
+    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_EEPROM_SIZE;
     void *   source                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
     uint8_t *target                     = data;
+#ifdef DYNAMIC_KEYMAP_USE_RAM_MIRROR
+    dynamic_keymap_init();
+#endif
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < dynamic_keymap_eeprom_size) {
+#ifdef DYNAMIC_KEYMAP_USE_RAM_MIRROR
+            *target = dynamic_keymap_mirror_get_byte(offset + i);
+#else
             *target = eeprom_read_byte(source);
+#endif
         } else {
             *target = 0x00;
         }
@@ -132,16 +205,23 @@ void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
 }
 
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
+    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_EEPROM_SIZE;
     void *   target                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
     uint8_t *source                     = data;
+#ifdef DYNAMIC_KEYMAP_USE_RAM_MIRROR
+    dynamic_keymap_init();
+#endif
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < dynamic_keymap_eeprom_size) {
             eeprom_update_byte(target, *source);
+#ifdef DYNAMIC_KEYMAP_USE_RAM_MIRROR
+            dynamic_keymap_mirror_set_byte(offset + i, *source);
+#endif
         }
         source++;
         target++;
     }
+    resolved_layer_cache_invalidate();
 }
 
 // This overrides the one in quantum/keymap_common.c
@@ -18,6 +18,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Loads the RAM copy of the keymap, if one is used (see DYNAMIC_KEYMAP_RAM_MIRROR_MAX_SIZE)
+void     dynamic_keymap_init(void);
 uint8_t  dynamic_keymap_get_layer_count(void);
 void *   dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t column);
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column);
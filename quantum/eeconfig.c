@@ -1,8 +1,10 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "eeprom.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "timer.h"
 
 #if defined(EEPROM_DRIVER)
 #    include "eeprom_driver.h"
@@ -12,6 +14,92 @@
 #    include "haptic.h"
 #endif
 
+#ifdef EECONFIG_CACHE_ENABLE
+static uint8_t  eeconfig_cache[EECONFIG_SIZE];
+static bool     eeconfig_cache_loaded = false;
+static bool     eeconfig_cache_dirty  = false;
+static uint8_t  eeconfig_cache_dirty_start;
+static uint8_t  eeconfig_cache_dirty_end;
+static uint16_t eeconfig_cache_first_change;
+static uint16_t eeconfig_cache_last_change;
+
+static void eeconfig_cache_load(void) {
+    if (!eeconfig_cache_loaded) {
+        eeprom_read_block(eeconfig_cache, (const void *)0, EECONFIG_SIZE);
+        eeconfig_cache_loaded = true;
+    }
+}
+
+/** \brief Drop the cached copy, e.g. after the EEPROM has been erased underneath it
+ */
+static void eeconfig_cache_invalidate(void) {
+    eeconfig_cache_loaded = false;
+    eeconfig_cache_dirty  = false;
+}
+
+static inline bool eeconfig_cache_contains(const void *addr, size_t len) { return (uintptr_t)addr + len <= EECONFIG_SIZE; }
+
+void eeconfig_read_block(void *buf, const void *addr, size_t len) {
+    if (!eeconfig_cache_contains(addr, len)) {
+        eeprom_read_block(buf, addr, len);
+        return;
+    }
+
+    eeconfig_cache_load();
+    memcpy(buf, &eeconfig_cache[(uintptr_t)addr], len);
+}
+
+void eeconfig_update_block(const void *buf, void *addr, size_t len) {
+    if (!eeconfig_cache_contains(addr, len)) {
+        eeprom_update_block(buf, addr, len);
+        return;
+    }
+
+    eeconfig_cache_load();
+    const uint8_t *src    = buf;
+    uint8_t        offset = (uintptr_t)addr;
+    for (uint8_t i = 0; i < len; i++, offset++) {
+        if (eeconfig_cache[offset] == src[i]) {
+            continue;
+        }
+        eeconfig_cache[offset] = src[i];
+
+        // Track the span of changed bytes, it is written back in one go
+        if (!eeconfig_cache_dirty) {
+            eeconfig_cache_dirty        = true;
+            eeconfig_cache_dirty_start  = offset;
+            eeconfig_cache_dirty_end    = offset + 1;
+            eeconfig_cache_first_change = timer_read();
+        } else if (offset < eeconfig_cache_dirty_start) {
+            eeconfig_cache_dirty_start = offset;
+        } else if (offset >= eeconfig_cache_dirty_end) {
+            eeconfig_cache_dirty_end = offset + 1;
+        }
+        eeconfig_cache_last_change = timer_read();
+    }
+}
+
+/** \brief Write any pending changes back to the EEPROM
+ *
+ * Called automatically from eeconfig_task(), before suspending and before jumping to the bootloader.
+ */
+void eeconfig_flush(void) {
+    if (eeconfig_cache_dirty) {
+        // Unchanged bytes within the span are skipped by eeprom_update_block()
+        eeprom_update_block(&eeconfig_cache[eeconfig_cache_dirty_start], (void *)(uintptr_t)eeconfig_cache_dirty_start, eeconfig_cache_dirty_end - eeconfig_cache_dirty_start);
+        eeconfig_cache_dirty = false;
+    }
+}
+
+void eeconfig_task(void) {
+    if (eeconfig_cache_dirty && (timer_elapsed(eeconfig_cache_last_change) >= EECONFIG_CACHE_FLUSH_DELAY || timer_elapsed(eeconfig_cache_first_change) >= EECONFIG_CACHE_MAX_STALENESS)) {
+        eeconfig_flush();
+    }
+}
+#else
+#    define eeconfig_cache_invalidate()
+#endif
+
 #if defined(VIA_ENABLE)
 bool via_eeprom_is_valid(void);
 void via_eeprom_set_valid(bool valid);
@@ -41,30 +129,31 @@ void eeconfig_init_quantum(void) {
 #if defined(EEPROM_DRIVER)
     eeprom_driver_erase();
 #endif
-    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
-    eeprom_update_byte(EECONFIG_DEBUG, 0);
-    eeprom_update_byte(EECONFIG_DEFAULT_LAYER, 0);
+    eeconfig_cache_invalidate();
+    eeconfig_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+    eeconfig_update_byte(EECONFIG_DEBUG, 0);
+    eeconfig_update_byte(EECONFIG_DEFAULT_LAYER, 0);
     default_layer_state = 0;
-    eeprom_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, 0);
-    eeprom_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, 0);
-    eeprom_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
-    eeprom_update_byte(EECONFIG_BACKLIGHT, 0);
-    eeprom_update_byte(EECONFIG_AUDIO, 0xFF);  // On by default
-    eeprom_update_dword(EECONFIG_RGBLIGHT, 0);
-    eeprom_update_byte(EECONFIG_STENOMODE, 0);
-    eeprom_update_dword(EECONFIG_HAPTIC, 0);
-    eeprom_update_byte(EECONFIG_VELOCIKEY, 0);
-    eeprom_update_dword(EECONFIG_RGB_MATRIX, 0);
-    eeprom_update_word(EECONFIG_RGB_MATRIX_EXTENDED, 0);
+    eeconfig_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, 0);
+    eeconfig_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, 0);
+    eeconfig_update_byte(EECONFIG_MOUSEKEY_ACCEL, 0);
+    eeconfig_update_byte(EECONFIG_BACKLIGHT, 0);
+    eeconfig_update_byte(EECONFIG_AUDIO, 0xFF);  // On by default
+    eeconfig_update_dword(EECONFIG_RGBLIGHT, 0);
+    eeconfig_update_byte(EECONFIG_STENOMODE, 0);
+    eeconfig_update_dword(EECONFIG_HAPTIC, 0);
+    eeconfig_update_byte(EECONFIG_VELOCIKEY, 0);
+    eeconfig_update_dword(EECONFIG_RGB_MATRIX, 0);
+    eeconfig_update_word(EECONFIG_RGB_MATRIX_EXTENDED, 0);
 
     // TODO: Remove once ARM has a way to configure EECONFIG_HANDEDNESS
     //        within the emulated eeprom via dfu-util or another tool
 #if defined INIT_EE_HANDS_LEFT
 #    pragma message "Faking EE_HANDS for left hand"
-    eeprom_update_byte(EECONFIG_HANDEDNESS, 1);
+    eeconfig_update_byte(EECONFIG_HANDEDNESS, 1);
 #elif defined INIT_EE_HANDS_RIGHT
 #    pragma message "Faking EE_HANDS for right hand"
-    eeprom_update_byte(EECONFIG_HANDEDNESS, 0);
+    eeconfig_update_byte(EECONFIG_HANDEDNESS, 0);
 #endif
 
 #if defined(HAPTIC_ENABLE)
@@ -73,7 +162,7 @@ void eeconfig_init_quantum(void) {
     // this is used in case haptic is disabled, but we still want sane defaults
     // in the haptic configuration eeprom. All zero will trigger a haptic_reset
     // when a haptic-enabled firmware is loaded onto the keyboard.
-    eeprom_update_dword(EECONFIG_HAPTIC, 0);
+    eeconfig_update_dword(EECONFIG_HAPTIC, 0);
 #endif
 #if defined(VIA_ENABLE)
     // Invalidate VIA eeprom config, and then reset.
@@ -84,6 +173,7 @@ void eeconfig_init_quantum(void) {
 #endif
 
     eeconfig_init_kb();
+    eeconfig_flush();
 }
 
 /** \brief eeconfig initialization
@@ -96,7 +186,10 @@ void eeconfig_init(void) { eeconfig_init_quantum(); }
  *
  * FIXME: needs doc
  */
-void eeconfig_enable(void) { eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER); }
+void eeconfig_enable(void) {
+    eeconfig_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER);
+    eeconfig_flush();
+}
 
 /** \brief eeconfig disable
  *
@@ -106,7 +199,9 @@ void eeconfig_disable(void) {
 #if defined(EEPROM_DRIVER)
     eeprom_driver_erase();
 #endif
-    eeprom_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER_OFF);
+    eeconfig_cache_invalidate();
+    eeconfig_update_word(EECONFIG_MAGIC, EECONFIG_MAGIC_NUMBER_OFF);
+    eeconfig_flush();
 }
 
 /** \brief eeconfig is enabled
@@ -114,7 +209,7 @@ void eeconfig_disable(void) {
  * FIXME: needs doc
  */
 bool eeconfig_is_enabled(void) {
-    bool is_eeprom_enabled = (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER);
+    bool is_eeprom_enabled = (eeconfig_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER);
 #ifdef VIA_ENABLE
     if (is_eeprom_enabled) {
         is_eeprom_enabled = via_eeprom_is_valid();
@@ -128,7 +223,7 @@ bool eeconfig_is_enabled(void) {
  * FIXME: needs doc
  */
 bool eeconfig_is_disabled(void) {
-    bool is_eeprom_disabled = (eeprom_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER_OFF);
+    bool is_eeprom_disabled = (eeconfig_read_word(EECONFIG_MAGIC) == EECONFIG_MAGIC_NUMBER_OFF);
 #ifdef VIA_ENABLE
     if (!is_eeprom_disabled) {
         is_eeprom_disabled = !via_eeprom_is_valid();
@@ -141,89 +236,89 @@ bool eeconfig_is_disabled(void) {
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_debug(void) { return eeprom_read_byte(EECONFIG_DEBUG); }
+uint8_t eeconfig_read_debug(void) { return eeconfig_read_byte(EECONFIG_DEBUG); }
 /** \brief eeconfig update debug
  *
  * FIXME: needs doc
  */
-void eeconfig_update_debug(uint8_t val) { eeprom_update_byte(EECONFIG_DEBUG, val); }
+void eeconfig_update_debug(uint8_t val) { eeconfig_update_byte(EECONFIG_DEBUG, val); }
 
 /** \brief eeconfig read default layer
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_default_layer(void) { return eeprom_read_byte(EECONFIG_DEFAULT_LAYER); }
+uint8_t eeconfig_read_default_layer(void) { return eeconfig_read_byte(EECONFIG_DEFAULT_LAYER); }
 /** \brief eeconfig update default layer
  *
  * FIXME: needs doc
  */
-void eeconfig_update_default_layer(uint8_t val) { eeprom_update_byte(EECONFIG_DEFAULT_LAYER, val); }
+void eeconfig_update_default_layer(uint8_t val) { eeconfig_update_byte(EECONFIG_DEFAULT_LAYER, val); }
 
 /** \brief eeconfig read keymap
  *
  * FIXME: needs doc
  */
-uint16_t eeconfig_read_keymap(void) { return (eeprom_read_byte(EECONFIG_KEYMAP_LOWER_BYTE) | (eeprom_read_byte(EECONFIG_KEYMAP_UPPER_BYTE) << 8)); }
+uint16_t eeconfig_read_keymap(void) { return (eeconfig_read_byte(EECONFIG_KEYMAP_LOWER_BYTE) | (eeconfig_read_byte(EECONFIG_KEYMAP_UPPER_BYTE) << 8)); }
 /** \brief eeconfig update keymap
  *
  * FIXME: needs doc
  */
 void eeconfig_update_keymap(uint16_t val) {
-    eeprom_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, val & 0xFF);
-    eeprom_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, (val >> 8) & 0xFF);
+    eeconfig_update_byte(EECONFIG_KEYMAP_LOWER_BYTE, val & 0xFF);
+    eeconfig_update_byte(EECONFIG_KEYMAP_UPPER_BYTE, (val >> 8) & 0xFF);
 }
 
 /** \brief eeconfig read audio
  *
  * FIXME: needs doc
  */
-uint8_t eeconfig_read_audio(void) { return eeprom_read_byte(EECONFIG_AUDIO); }
+uint8_t eeconfig_read_audio(void) { return eeconfig_read_byte(EECONFIG_AUDIO); }
 /** \brief eeconfig update audio
  *
  * FIXME: needs doc
  */
-void eeconfig_update_audio(uint8_t val) { eeprom_update_byte(EECONFIG_AUDIO, val); }
+void eeconfig_update_audio(uint8_t val) { eeconfig_update_byte(EECONFIG_AUDIO, val); }
 
 /** \brief eeconfig read kb
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_kb(void) { return eeprom_read_dword(EECONFIG_KEYBOARD); }
+uint32_t eeconfig_read_kb(void) { return eeconfig_read_dword(EECONFIG_KEYBOARD); }
 /** \brief eeconfig update kb
  *
  * FIXME: needs doc
  */
-void eeconfig_update_kb(uint32_t val) { eeprom_update_dword(EECONFIG_KEYBOARD, val); }
+void eeconfig_update_kb(uint32_t val) { eeconfig_update_dword(EECONFIG_KEYBOARD, val); }
 
 /** \brief eeconfig read user
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_user(void) { return eeprom_read_dword(EECONFIG_USER); }
+uint32_t eeconfig_read_user(void) { return eeconfig_read_dword(EECONFIG_USER); }
 /** \brief eeconfig update user
  *
  * FIXME: needs doc
  */
-void eeconfig_update_user(uint32_t val) { eeprom_update_dword(EECONFIG_USER, val); }
+void eeconfig_update_user(uint32_t val) { eeconfig_update_dword(EECONFIG_USER, val); }
 
 /** \brief eeconfig read haptic
  *
  * FIXME: needs doc
  */
-uint32_t eeconfig_read_haptic(void) { return eeprom_read_dword(EECONFIG_HAPTIC); }
+uint32_t eeconfig_read_haptic(void) { return eeconfig_read_dword(EECONFIG_HAPTIC); }
 /** \brief eeconfig update haptic
  *
  * FIXME: needs doc
  */
-void eeconfig_update_haptic(uint32_t val) { eeprom_update_dword(EECONFIG_HAPTIC, val); }
+void eeconfig_update_haptic(uint32_t val) { eeconfig_update_dword(EECONFIG_HAPTIC, val); }
 
 /** \brief eeconfig read split handedness
  *
  * FIXME: needs doc
  */
-bool eeconfig_read_handedness(void) { return !!eeprom_read_byte(EECONFIG_HANDEDNESS); }
+bool eeconfig_read_handedness(void) { return !!eeconfig_read_byte(EECONFIG_HANDEDNESS); }
 /** \brief eeconfig update split handedness
  *
  * FIXME: needs doc
  */
-void eeconfig_update_handedness(bool val) { eeprom_update_byte(EECONFIG_HANDEDNESS, !!val); }
+void eeconfig_update_handedness(bool val) { eeconfig_update_byte(EECONFIG_HANDEDNESS, !!val); }
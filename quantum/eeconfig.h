@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifndef EECONFIG_MAGIC_NUMBER
 #    define EECONFIG_MAGIC_NUMBER (uint16_t)0xFEE9  // When changing, decrement this value to avoid future re-init issues
@@ -112,16 +113,63 @@ void     eeconfig_update_haptic(uint32_t val);
 bool eeconfig_read_handedness(void);
 void eeconfig_update_handedness(bool val);
 
+#ifdef EECONFIG_CACHE_ENABLE
+#    ifndef EECONFIG_CACHE_FLUSH_DELAY
+#        define EECONFIG_CACHE_FLUSH_DELAY 1000
+#    endif
+#    ifndef EECONFIG_CACHE_MAX_STALENESS
+#        define EECONFIG_CACHE_MAX_STALENESS 10000
+#    endif
+
+/* The EECONFIG region is mirrored in RAM, writes only mark the changed bytes dirty.
+ * Dirty bytes are written back once no further changes have been made for
+ * EECONFIG_CACHE_FLUSH_DELAY ms, or at the latest EECONFIG_CACHE_MAX_STALENESS ms
+ * after the first change. Addresses outside of the region go straight to the EEPROM. */
+void eeconfig_read_block(void *buf, const void *addr, size_t len);
+void eeconfig_update_block(const void *buf, void *addr, size_t len);
+void eeconfig_flush(void);
+void eeconfig_task(void);
+
+static inline uint8_t eeconfig_read_byte(const uint8_t *addr) {
+    uint8_t val;
+    eeconfig_read_block(&val, addr, sizeof(val));
+    return val;
+}
+static inline uint16_t eeconfig_read_word(const uint16_t *addr) {
+    uint16_t val;
+    eeconfig_read_block(&val, addr, sizeof(val));
+    return val;
+}
+static inline uint32_t eeconfig_read_dword(const uint32_t *addr) {
+    uint32_t val;
+    eeconfig_read_block(&val, addr, sizeof(val));
+    return val;
+}
+static inline void eeconfig_update_byte(uint8_t *addr, uint8_t val) { eeconfig_update_block(&val, addr, sizeof(val)); }
+static inline void eeconfig_update_word(uint16_t *addr, uint16_t val) { eeconfig_update_block(&val, addr, sizeof(val)); }
+static inline void eeconfig_update_dword(uint32_t *addr, uint32_t val) { eeconfig_update_block(&val, addr, sizeof(val)); }
+#else
+#    define eeconfig_read_byte(addr) eeprom_read_byte(addr)
+#    define eeconfig_read_word(addr) eeprom_read_word(addr)
+#    define eeconfig_read_dword(addr) eeprom_read_dword(addr)
+#    define eeconfig_read_block(buf, addr, len) eeprom_read_block(buf, addr, len)
+#    define eeconfig_update_byte(addr, val) eeprom_update_byte(addr, val)
+#    define eeconfig_update_word(addr, val) eeprom_update_word(addr, val)
+#    define eeconfig_update_dword(addr, val) eeprom_update_dword(addr, val)
+#    define eeconfig_update_block(buf, addr, len) eeprom_update_block(buf, addr, len)
+#    define eeconfig_flush()
+#endif
+
 #define EECONFIG_DEBOUNCE_HELPER(name, offset, config)                     \
     static uint8_t dirty_##name = false;                                   \
                                                                            \
     static inline void eeconfig_init_##name(void) {                        \
-        eeprom_read_block(&config, offset, sizeof(config));                \
+        eeconfig_read_block(&config, offset, sizeof(config));              \
         dirty_##name = false;                                              \
     }                                                                      \
     static inline void eeconfig_flush_##name(bool force) {                 \
         if (force || dirty_##name) {                                       \
-            eeprom_update_block(&config, offset, sizeof(config));          \
+            eeconfig_update_block(&config, offset, sizeof(config));        \
             dirty_##name = false;                                          \
         }                                                                  \
     }                                                                      \
@@ -19,6 +19,13 @@
 #ifdef SPLIT_KEYBOARD
 #    include "split_util.h"
 #endif
+#ifdef ENCODER_INTERRUPT_ENABLE
+#    include "pin_interrupt.h"
+#    include "atomic_util.h"
+#    ifdef MATRIX_IDLE_SLEEP_ENABLE
+#        include "pin_wakeup.h"
+#    endif
+#endif
 
 // for memcpy
 #include <string.h>
@@ -27,6 +34,11 @@
 #    define ENCODER_RESOLUTION 4
 #endif
 
+// Steps further apart than this are treated as the encoder having come to rest
+#ifndef ENCODER_VELOCITY_TIMEOUT
+#    define ENCODER_VELOCITY_TIMEOUT 250
+#endif
+
 #if !defined(ENCODERS_PAD_A) || !defined(ENCODERS_PAD_B)
 #    error "No encoder pads defined by ENCODERS_PAD_A and ENCODERS_PAD_B"
 #endif
@@ -48,7 +60,14 @@ static uint8_t encoder_resolutions[] = ENCODER_RESOLUTIONS;
 static int8_t encoder_LUT[] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
 
 static uint8_t encoder_state[NUMBER_OF_ENCODERS]  = {0};
-static int8_t  encoder_pulses[NUMBER_OF_ENCODERS] = {0};
+static int16_t encoder_pulses[NUMBER_OF_ENCODERS] = {0};
+
+#ifdef ENCODER_INTERRUPT_ENABLE
+// Pulses decoded by the pin interrupts since the last encoder_read()
+static volatile uint8_t encoder_isr_state[NUMBER_OF_ENCODERS]  = {0};
+static volatile int16_t encoder_isr_pulses[NUMBER_OF_ENCODERS] = {0};
+static bool             encoder_use_isr[NUMBER_OF_ENCODERS]    = {0};
+#endif
 
 #ifdef SPLIT_KEYBOARD
 // right half encoders come over as second set of encoders
@@ -58,11 +77,31 @@ static uint8_t thisHand, thatHand;
 #else
 static uint8_t encoder_value[NUMBER_OF_ENCODERS] = {0};
 #endif
+#define NUMBER_OF_ENCODER_VALUES sizeof(encoder_value)
+
+// Steps per second, smoothed over consecutive steps, and its change per second
+static int16_t  encoder_velocity[NUMBER_OF_ENCODER_VALUES]     = {0};
+static int16_t  encoder_acceleration[NUMBER_OF_ENCODER_VALUES] = {0};
+static uint16_t encoder_last_step[NUMBER_OF_ENCODER_VALUES]    = {0};
 
 __attribute__((weak)) bool encoder_update_user(uint8_t index, bool clockwise) { return true; }
 
 __attribute__((weak)) bool encoder_update_kb(uint8_t index, bool clockwise) { return encoder_update_user(index, clockwise); }
 
+#ifdef ENCODER_INTERRUPT_ENABLE
+static void encoder_isr(void* arg) {
+    uint8_t i     = (uintptr_t)arg;
+    uint8_t state = (encoder_isr_state[i] << 2) | (readPin(encoders_pad_a[i]) << 0) | (readPin(encoders_pad_b[i]) << 1);
+
+    encoder_isr_state[i] = state;
+    encoder_isr_pulses[i] += encoder_LUT[state & 0xF];
+#    ifdef MATRIX_IDLE_SLEEP_ENABLE
+    // have the main loop pick up the step, rather than leaving it until the matrix wakes up
+    pin_wakeup_signal_from_isr();
+#    endif
+}
+#endif
+
 void encoder_init(void) {
 #if defined(SPLIT_KEYBOARD) && defined(ENCODERS_PAD_A_RIGHT) && defined(ENCODERS_PAD_B_RIGHT)
     if (!isLeftHand) {
@@ -86,6 +125,18 @@ void encoder_init(void) {
         setPinInputHigh(encoders_pad_b[i]);
 
         encoder_state[i] = (readPin(encoders_pad_a[i]) << 0) | (readPin(encoders_pad_b[i]) << 1);
+
+#ifdef ENCODER_INTERRUPT_ENABLE
+        encoder_isr_state[i] = encoder_state[i];
+        if (pin_interrupt_enable(encoders_pad_a[i], PIN_INTERRUPT_BOTH_EDGES, encoder_isr, (void*)(uintptr_t)i)) {
+            if (pin_interrupt_enable(encoders_pad_b[i], PIN_INTERRUPT_BOTH_EDGES, encoder_isr, (void*)(uintptr_t)i)) {
+                encoder_use_isr[i] = true;
+            } else {
+                // both pads are needed to decode, so fall back to polling this encoder
+                pin_interrupt_disable(encoders_pad_a[i]);
+            }
+        }
+#endif
     }
 
 #ifdef SPLIT_KEYBOARD
@@ -94,8 +145,49 @@ void encoder_init(void) {
 #endif
 }
 
-static bool encoder_update(uint8_t index, uint8_t state) {
+// steps are counted the way encoder_value moves, velocity is positive for clockwise
+static void encoder_track_velocity(uint8_t index, int16_t steps) {
+    uint16_t elapsed = timer_elapsed(encoder_last_step[index]);
+    int16_t  last    = encoder_get_velocity(index);
+
+    if (ENCODER_CLOCKWISE) {
+        steps = -steps;
+    }
+
+    encoder_last_step[index] = timer_read();
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+
+    int32_t velocity = ((int32_t)steps * 1000 / elapsed + last) / 2;
+    if (velocity > INT16_MAX) velocity = INT16_MAX;
+    if (velocity < -INT16_MAX) velocity = -INT16_MAX;
+
+    int32_t acceleration = (velocity - last) * 1000 / elapsed;
+    if (acceleration > INT16_MAX) acceleration = INT16_MAX;
+    if (acceleration < -INT16_MAX) acceleration = -INT16_MAX;
+
+    encoder_velocity[index]     = velocity;
+    encoder_acceleration[index] = acceleration;
+}
+
+int16_t encoder_get_velocity(uint8_t index) {
+    if (index >= NUMBER_OF_ENCODER_VALUES || timer_elapsed(encoder_last_step[index]) > ENCODER_VELOCITY_TIMEOUT) {
+        return 0;
+    }
+    return encoder_velocity[index];
+}
+
+int16_t encoder_get_acceleration(uint8_t index) {
+    if (index >= NUMBER_OF_ENCODER_VALUES || timer_elapsed(encoder_last_step[index]) > ENCODER_VELOCITY_TIMEOUT) {
+        return 0;
+    }
+    return encoder_acceleration[index];
+}
+
+static bool encoder_update(uint8_t index, int16_t pulses, uint8_t state) {
     bool    changed = false;
+    int16_t steps   = 0;
     uint8_t i       = index;
 
 #ifdef ENCODER_RESOLUTIONS
@@ -107,32 +199,69 @@ static bool encoder_update(uint8_t index, uint8_t state) {
 #ifdef SPLIT_KEYBOARD
     index += thisHand;
 #endif
-    encoder_pulses[i] += encoder_LUT[state & 0xF];
-    if (encoder_pulses[i] >= resolution) {
+    encoder_pulses[i] += pulses;
+    while (encoder_pulses[i] >= resolution) {
+        steps++;
+        encoder_pulses[i] -= resolution;
+    }
+    while (encoder_pulses[i] <= -resolution) {  // direction is arbitrary here, but this clockwise
+        steps--;
+        encoder_pulses[i] += resolution;
+    }
+#ifdef ENCODER_DEFAULT_POS
+    if ((state & 0x3) == ENCODER_DEFAULT_POS) {
+        encoder_pulses[i] = 0;
+    }
+#endif
+
+    if (steps) {
+        encoder_track_velocity(index, steps);
+    }
+    for (; steps > 0; steps--) {
         encoder_value[index]++;
         changed = true;
         encoder_update_kb(index, ENCODER_COUNTER_CLOCKWISE);
     }
-    if (encoder_pulses[i] <= -resolution) {  // direction is arbitrary here, but this clockwise
+    for (; steps < 0; steps++) {
         encoder_value[index]--;
         changed = true;
         encoder_update_kb(index, ENCODER_CLOCKWISE);
     }
-    encoder_pulses[i] %= resolution;
-#ifdef ENCODER_DEFAULT_POS
-    if ((state & 0x3) == ENCODER_DEFAULT_POS) {
-        encoder_pulses[i] = 0;
-    }
-#endif
     return changed;
 }
 
+#ifdef ENCODER_INTERRUPT_ENABLE
+bool encoder_needs_polling(void) {
+    for (uint8_t i = 0; i < NUMBER_OF_ENCODERS; i++) {
+        if (!encoder_use_isr[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
 bool encoder_read(void) {
     bool changed = false;
     for (uint8_t i = 0; i < NUMBER_OF_ENCODERS; i++) {
+#ifdef ENCODER_INTERRUPT_ENABLE
+        if (encoder_use_isr[i]) {
+            // only drain what the interrupts have decoded since the last read
+            int16_t pulses;
+            ATOMIC_BLOCK_FORCEON {
+                pulses                = encoder_isr_pulses[i];
+                encoder_state[i]      = encoder_isr_state[i];
+                encoder_isr_pulses[i] = 0;
+            }
+            if (pulses) {
+                changed |= encoder_update(i, pulses, encoder_state[i]);
+            }
+            continue;
+        }
+#endif
         encoder_state[i] <<= 2;
         encoder_state[i] |= (readPin(encoders_pad_a[i]) << 0) | (readPin(encoders_pad_b[i]) << 1);
-        changed |= encoder_update(i, encoder_state[i]);
+        changed |= encoder_update(i, encoder_LUT[encoder_state[i] & 0xF], encoder_state[i]);
     }
     return changed;
 }
@@ -147,6 +276,9 @@ void encoder_update_raw(uint8_t* slave_state) {
     for (uint8_t i = 0; i < NUMBER_OF_ENCODERS; i++) {
         uint8_t index = i + thatHand;
         int8_t  delta = slave_state[i] - encoder_value[index];
+        if (delta) {
+            encoder_track_velocity(index, delta);
+        }
         while (delta > 0) {
             delta--;
             encoder_value[index]++;
@@ -25,6 +25,22 @@ bool encoder_read(void);
 bool encoder_update_kb(uint8_t index, bool clockwise);
 bool encoder_update_user(uint8_t index, bool clockwise);
 
+/** \brief Returns how fast an encoder is turning, in steps per second
+ *
+ * Positive values are clockwise. Returns 0 once the encoder has been at rest for ENCODER_VELOCITY_TIMEOUT ms.
+ */
+int16_t encoder_get_velocity(uint8_t index);
+
+/** \brief Returns how fast the velocity of an encoder is changing, in steps per second squared
+ */
+int16_t encoder_get_acceleration(uint8_t index);
+
+#ifdef ENCODER_INTERRUPT_ENABLE
+/** \brief Returns true if any encoder couldn't get pin interrupts and is polled from the main loop instead
+ */
+bool encoder_needs_polling(void);
+#endif
+
 #ifdef SPLIT_KEYBOARD
 void encoder_state_raw(uint8_t* slave_state);
 void encoder_update_raw(uint8_t* slave_state);
@@ -31,6 +31,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sendchar.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "action_util.h"
+#include "latency_profile.h"
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif
@@ -82,6 +84,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef VIA_ENABLE
 #    include "via.h"
 #endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+#    include "dynamic_keymap.h"
+#endif
 #ifdef DIP_SWITCH_ENABLE
 #    include "dip_switch.h"
 #endif
@@ -299,6 +304,9 @@ void keyboard_init(void) {
     sync_timer_init();
 #ifdef VIA_ENABLE
     via_init();
+#endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+    dynamic_keymap_init();
 #endif
     matrix_init();
 #if defined(CRC_ENABLE)
@@ -363,6 +371,80 @@ void switch_events(uint8_t row, uint8_t col, bool pressed) {
 #endif
 }
 
+/** \brief Time to stamp a key event with
+ *
+ * With MATRIX_IDLE_SLEEP_ENABLE, the first event after a wakeup gets the time of the key press that woke the
+ * matrix, rather than the time it was scanned and debounced.
+ */
+static uint16_t key_event_time(void) {
+#ifdef MATRIX_IDLE_SLEEP_ENABLE
+    uint32_t wakeup_time;
+    if (matrix_idle_take_wakeup_time(&wakeup_time)) {
+        return (uint16_t)wakeup_time | 1; /* time should not be 0 */
+    }
+#endif
+    return timer_read() | 1; /* time should not be 0 */
+}
+
+#ifdef KEYBOARD_EVENT_BATCHING
+#    ifndef KEYBOARD_EVENT_QUEUE_SIZE
+#        define KEYBOARD_EVENT_QUEUE_SIZE 16
+#    endif
+
+/** \brief Process every matrix change found by one scan as a single batch
+ *
+ * All events share one timestamp, see key_event_time(), and the resulting
+ * keyboard reports are coalesced into as few as possible. Changes that do not fit in
+ * the event queue are left pending in matrix_prev and picked up by the next scan.
+ *
+ * Returns the number of events processed.
+ */
+static uint8_t matrix_process_batch(matrix_row_t matrix_prev[]) {
+    keyevent_t events[KEYBOARD_EVENT_QUEUE_SIZE];
+    uint8_t    event_count = 0;
+
+    for (uint8_t r = 0; r < MATRIX_ROWS && event_count < KEYBOARD_EVENT_QUEUE_SIZE; r++) {
+        matrix_row_t matrix_row    = matrix_get_row(r);
+        matrix_row_t matrix_change = matrix_row ^ matrix_prev[r];
+        if (matrix_change) {
+#    ifdef MATRIX_HAS_GHOST
+            if (has_ghost_in_row(r, matrix_row)) {
+                continue;
+            }
+#    endif
+            if (debug_matrix) matrix_print();
+            matrix_row_t col_mask = 1;
+            for (uint8_t c = 0; c < MATRIX_COLS && event_count < KEYBOARD_EVENT_QUEUE_SIZE; c++, col_mask <<= 1) {
+                if (matrix_change & col_mask) {
+                    events[event_count++] = (keyevent_t){.key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask)};
+                    // record a queued key
+                    matrix_prev[r] ^= col_mask;
+                }
+            }
+        }
+    }
+
+    if (event_count == 0) {
+        return 0;
+    }
+
+    // Only taken once there are events, an empty scan must not use up the wakeup time
+    const uint16_t scan_time        = key_event_time();
+    const bool     process_keypress = should_process_keypress();
+    if (process_keypress) begin_keyboard_report_batch();
+    for (uint8_t i = 0; i < event_count; i++) {
+        events[i].time = scan_time;
+        if (process_keypress) {
+            action_exec(events[i]);
+        }
+        switch_events(events[i].key.row, events[i].key.col, events[i].pressed);
+    }
+    if (process_keypress) end_keyboard_report_batch();
+
+    return event_count;
+}
+#endif
+
 /** \brief Keyboard task: Do keyboard routine jobs
  *
  * Do routine keyboard jobs:
@@ -376,19 +458,29 @@ void switch_events(uint8_t row, uint8_t col, bool pressed) {
  */
 void keyboard_task(void) {
     static matrix_row_t matrix_prev[MATRIX_ROWS];
-    static uint8_t      led_status    = 0;
-    matrix_row_t        matrix_row    = 0;
-    matrix_row_t        matrix_change = 0;
-#ifdef QMK_KEYS_PER_SCAN
+    static uint8_t      led_status = 0;
+#ifndef KEYBOARD_EVENT_BATCHING
+    matrix_row_t matrix_row    = 0;
+    matrix_row_t matrix_change = 0;
+#    ifdef QMK_KEYS_PER_SCAN
     uint8_t keys_processed = 0;
+#    endif
 #endif
 #ifdef ENCODER_ENABLE
     bool encoders_changed = false;
 #endif
+    LATENCY_PROFILE_START(task_start);
 
+    LATENCY_PROFILE_START(scan_start);
     uint8_t matrix_changed = matrix_scan();
+    LATENCY_PROFILE_STOP(scan_start, LATENCY_STAGE_MATRIX_SCAN);
     if (matrix_changed) last_matrix_activity_trigger();
 
+    LATENCY_PROFILE_START(action_start);
+#ifdef KEYBOARD_EVENT_BATCHING
+    // call with pseudo tick event when no real key event.
+    if (!matrix_process_batch(matrix_prev)) action_exec(TICK);
+#else
     for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
         matrix_row    = matrix_get_row(r);
         matrix_change = matrix_row ^ matrix_prev[r];
@@ -404,7 +496,7 @@ void keyboard_task(void) {
                 if (matrix_change & col_mask) {
                     if (should_process_keypress()) {
                         action_exec((keyevent_t){
-                            .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = (timer_read() | 1) /* time should not be 0 */
+                            .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = key_event_time()
                         });
                     }
                     // record a processed key
@@ -430,11 +522,16 @@ void keyboard_task(void) {
         action_exec(TICK);
 
 MATRIX_LOOP_END:
+#endif
+    LATENCY_PROFILE_STOP(action_start, LATENCY_STAGE_ACTION_EXEC);
 
 #ifdef DEBUG_MATRIX_SCAN_RATE
     matrix_scan_perf_task();
 #endif
 
+#if defined(RGBLIGHT_ENABLE) || defined(LED_MATRIX_ENABLE) || defined(RGB_MATRIX_ENABLE)
+    LATENCY_PROFILE_START(lighting_start);
+#endif
 #if defined(RGBLIGHT_ENABLE)
     rgblight_task();
 #endif
@@ -445,6 +542,9 @@ MATRIX_LOOP_END:
 #ifdef RGB_MATRIX_ENABLE
     rgb_matrix_task();
 #endif
+#if defined(RGBLIGHT_ENABLE) || defined(LED_MATRIX_ENABLE) || defined(RGB_MATRIX_ENABLE)
+    LATENCY_PROFILE_STOP(lighting_start, LATENCY_STAGE_LIGHTING);
+#endif
 
 #if defined(BACKLIGHT_ENABLE)
 #    if defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS)
@@ -458,7 +558,9 @@ MATRIX_LOOP_END:
 #endif
 
 #ifdef OLED_ENABLE
+    LATENCY_PROFILE_START(oled_start);
     oled_task();
+    LATENCY_PROFILE_STOP(oled_start, LATENCY_STAGE_OLED);
 #    if OLED_TIMEOUT > 0
     // Wake up oled if user is using those fabulous keys or spinning those encoders!
 #        ifdef ENCODER_ENABLE
@@ -491,7 +593,9 @@ MATRIX_LOOP_END:
 #endif
 
 #ifdef POINTING_DEVICE_ENABLE
+    LATENCY_PROFILE_START(pointing_start);
     pointing_device_task();
+    LATENCY_PROFILE_STOP(pointing_start, LATENCY_STAGE_POINTING_DEVICE);
 #endif
 
 #ifdef MIDI_ENABLE
@@ -516,11 +620,20 @@ MATRIX_LOOP_END:
     programmable_button_send();
 #endif
 
+#ifdef EECONFIG_CACHE_ENABLE
+    eeconfig_task();
+#endif
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
         keyboard_set_leds(led_status);
     }
+
+    LATENCY_PROFILE_STOP(task_start, LATENCY_STAGE_KEYBOARD_TASK);
+#ifdef LATENCY_PROFILE_ENABLE
+    latency_profile_task();
+#endif
 }
 
 /** \brief keyboard set leds
@@ -0,0 +1,150 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "latency_profile.h"
+#include "timer.h"
+#include "print.h"
+#include "debug.h"
+
+#ifdef PROTOCOL_CHIBIOS
+#    include <ch.h>
+#    include "chibios_config.h"
+#endif
+
+#ifndef LATENCY_PROFILE_PRINT_INTERVAL
+#    define LATENCY_PROFILE_PRINT_INTERVAL 5000
+#endif
+
+static latency_stats_t stats[LATENCY_STAGE_COUNT];
+
+static const char *const stage_names[LATENCY_STAGE_COUNT] = {
+    [LATENCY_STAGE_KEYBOARD_TASK]   = "keyboard_task",
+    [LATENCY_STAGE_MATRIX_SCAN]     = "matrix_scan",
+    [LATENCY_STAGE_ACTION_EXEC]     = "action_exec",
+    [LATENCY_STAGE_LIGHTING]        = "lighting",
+    [LATENCY_STAGE_OLED]            = "oled_task",
+    [LATENCY_STAGE_POINTING_DEVICE] = "pointing_device_task",
+    [LATENCY_STAGE_USB_SEND]        = "usb_send",
+};
+
+/* Uses the cycle counter where ChibiOS provides one, otherwise the system tick. Other platforms only
+ * have the millisecond timer, so can override this with something finer grained.
+ */
+__attribute__((weak)) uint32_t latency_profile_read_us(void) {
+#if defined(PROTOCOL_CHIBIOS) && PORT_SUPPORTS_RT == TRUE
+    // Accumulate so the result doesn't wrap with the cycle counter
+    static rtcnt_t  last_cycles = 0;
+    static uint32_t now_us      = 0;
+    static rtcnt_t  remainder   = 0;
+    rtcnt_t         cycles      = chSysGetRealtimeCounterX();
+    rtcnt_t         elapsed     = cycles - last_cycles + remainder;
+    last_cycles                 = cycles;
+    now_us += elapsed / (CPU_CLOCK / 1000000);
+    remainder = elapsed % (CPU_CLOCK / 1000000);
+    return now_us;
+#elif defined(PROTOCOL_CHIBIOS)
+    return TIME_I2US(chVTGetSystemTimeX());
+#else
+    return timer_read32() * 1000;
+#endif
+}
+
+void latency_profile_record(latency_stage_t stage, uint32_t start_us) {
+    uint32_t         duration = latency_profile_read_us() - start_us;
+    latency_stats_t *entry    = &stats[stage];
+
+    if (entry->count == 0 || duration < entry->min_us) {
+        entry->min_us = duration;
+    }
+    if (duration > entry->max_us) {
+        entry->max_us = duration;
+    }
+    entry->count++;
+    entry->total_us += duration;
+
+    uint8_t bucket = 0;
+    while (duration >= 2 && bucket < LATENCY_PROFILE_BUCKETS - 1) {
+        duration >>= 1;
+        bucket++;
+    }
+    if (entry->histogram[bucket] < UINT16_MAX) {
+        entry->histogram[bucket]++;
+    }
+}
+
+const latency_stats_t *latency_profile_get(latency_stage_t stage) { return &stats[stage]; }
+
+const char *latency_profile_stage_name(latency_stage_t stage) { return stage < LATENCY_STAGE_COUNT ? stage_names[stage] : "unknown"; }
+
+void latency_profile_reset(void) { memset(stats, 0, sizeof(stats)); }
+
+void latency_profile_print(void) {
+    for (uint8_t stage = 0; stage < LATENCY_STAGE_COUNT; stage++) {
+        const latency_stats_t *entry = &stats[stage];
+        if (entry->count == 0) {
+            continue;
+        }
+        dprintf("%s: n=%lu min=%luus avg=%luus max=%luus\n", stage_names[stage], entry->count, entry->min_us, entry->total_us / entry->count, entry->max_us);
+        dprint("  histogram:");
+        for (uint8_t bucket = 0; bucket < LATENCY_PROFILE_BUCKETS; bucket++) {
+            dprintf(" %u", entry->histogram[bucket]);
+        }
+        dprint("\n");
+    }
+}
+
+static uint8_t *write_u32(uint8_t *data, uint32_t value) {
+    data[0] = (value >> 24) & 0xFF;
+    data[1] = (value >> 16) & 0xFF;
+    data[2] = (value >> 8) & 0xFF;
+    data[3] = value & 0xFF;
+    return data + 4;
+}
+
+void latency_profile_get_raw(uint8_t *data, uint8_t length) {
+    uint8_t         stage = data[0];
+    uint8_t         first = data[1];
+    latency_stats_t entry = {0};
+    if (stage < LATENCY_STAGE_COUNT) {
+        entry = stats[stage];
+    }
+
+    uint8_t *out = data + 2;
+    uint8_t *end = data + length;
+    if (out + 16 > end) {
+        return;
+    }
+    out = write_u32(out, entry.count);
+    out = write_u32(out, entry.min_us);
+    out = write_u32(out, entry.max_us);
+    out = write_u32(out, entry.count ? entry.total_us / entry.count : 0);
+    for (uint8_t bucket = first; bucket < LATENCY_PROFILE_BUCKETS && out + 2 <= end; bucket++) {
+        *out++ = entry.histogram[bucket] >> 8;
+        *out++ = entry.histogram[bucket] & 0xFF;
+    }
+}
+
+void latency_profile_task(void) {
+#if defined(CONSOLE_ENABLE) && LATENCY_PROFILE_PRINT_INTERVAL > 0
+    static uint32_t last_print = 0;
+    if (timer_elapsed32(last_print) >= LATENCY_PROFILE_PRINT_INTERVAL) {
+        last_print = timer_read32();
+        latency_profile_print();
+        latency_profile_reset();
+    }
+#endif
+}
@@ -0,0 +1,87 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// For more information about latency profiling see docs/faq_debug.md
+
+#ifndef LATENCY_PROFILE_BUCKETS
+#    define LATENCY_PROFILE_BUCKETS 16
+#endif
+
+typedef enum {
+    LATENCY_STAGE_KEYBOARD_TASK,  // the whole of keyboard_task()
+    LATENCY_STAGE_MATRIX_SCAN,
+    LATENCY_STAGE_ACTION_EXEC,  // processing matrix changes, up to and including action_exec()
+    LATENCY_STAGE_LIGHTING,     // rgblight_task(), led_matrix_task() and rgb_matrix_task()
+    LATENCY_STAGE_OLED,
+    LATENCY_STAGE_POINTING_DEVICE,
+    LATENCY_STAGE_USB_SEND,  // handing the keyboard report to the USB driver
+    LATENCY_STAGE_COUNT
+} latency_stage_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t total_us;
+    // Bucket 0 counts durations under 2us, bucket n durations of [2^n, 2^(n+1)) us, the last bucket everything longer
+    uint16_t histogram[LATENCY_PROFILE_BUCKETS];
+} latency_stats_t;
+
+#ifdef LATENCY_PROFILE_ENABLE
+
+/** \brief Reads the profiling clock, in microseconds */
+uint32_t latency_profile_read_us(void);
+
+/** \brief Records a stage that started at start_us, as returned by latency_profile_read_us() */
+void latency_profile_record(latency_stage_t stage, uint32_t start_us);
+
+/** \brief Returns the statistics gathered for a stage */
+const latency_stats_t *latency_profile_get(latency_stage_t stage);
+
+/** \brief Returns a printable name for a stage */
+const char *latency_profile_stage_name(latency_stage_t stage);
+
+/** \brief Clears all gathered statistics */
+void latency_profile_reset(void);
+
+/** \brief Prints the gathered statistics to the console */
+void latency_profile_print(void);
+
+/** \brief Fills a raw HID response
+ *
+ * data[0] selects the stage and data[1] the first histogram bucket to return. Filled in with the
+ * count, min, max and average durations as big-endian 32-bit values from data[2], followed by as many
+ * big-endian 16-bit histogram buckets as fit in length.
+ */
+void latency_profile_get_raw(uint8_t *data, uint8_t length);
+
+/** \brief Prints and resets the statistics to the console every LATENCY_PROFILE_PRINT_INTERVAL milliseconds */
+void latency_profile_task(void);
+
+#    define LATENCY_PROFILE_START(var) uint32_t var = latency_profile_read_us()
+#    define LATENCY_PROFILE_STOP(var, stage) latency_profile_record(stage, var)
+
+#else
+
+#    define LATENCY_PROFILE_START(var)
+#    define LATENCY_PROFILE_STOP(var, stage)
+
+#endif
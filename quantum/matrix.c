@@ -30,6 +30,29 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    define ROWS_PER_HAND (MATRIX_ROWS)
 #endif
 
+#ifdef MATRIX_IDLE_SLEEP_ENABLE
+#    ifdef SPLIT_KEYBOARD
+#        error MATRIX_IDLE_SLEEP_ENABLE is not supported on split keyboards
+#    endif
+#    if !defined(DIRECT_PINS) && !(defined(MATRIX_ROW_PINS) && defined(MATRIX_COL_PINS))
+#        error MATRIX_IDLE_SLEEP_ENABLE requires DIRECT_PINS or MATRIX_ROW_PINS and MATRIX_COL_PINS
+#    endif
+#    include "pin_wakeup.h"
+#    if defined(ENCODER_ENABLE) && defined(ENCODER_INTERRUPT_ENABLE)
+#        include "encoder.h"
+#    endif
+#    ifdef DEFERRED_EXEC_ENABLE
+#        include "deferred_exec.h"
+#    endif
+
+#    ifndef MATRIX_IDLE_TIMEOUT
+#        define MATRIX_IDLE_TIMEOUT 50
+#    endif
+#    ifndef MATRIX_IDLE_SLEEP_MAX
+#        define MATRIX_IDLE_SLEEP_MAX 10
+#    endif
+#endif
+
 #ifdef DIRECT_PINS_RIGHT
 #    define SPLIT_MUTABLE
 #else
@@ -129,6 +152,82 @@ __attribute__((weak)) void matrix_read_cols_on_row(matrix_row_t current_matrix[]
 #    if defined(MATRIX_ROW_PINS) && defined(MATRIX_COL_PINS)
 #        if (DIODE_DIRECTION == COL2ROW)
 
+#            ifdef MATRIX_READ_PORTS
+#                ifndef getPinPort
+#                    error MATRIX_READ_PORTS is not supported on this platform
+#                endif
+
+// A run of consecutive columns wired to consecutive bits of the same GPIO port
+typedef struct {
+    uint8_t     port;        // index into col_port_pins
+    uint8_t     port_shift;  // port bit of the first column in the run
+    uint8_t     col_shift;   // first column in the run
+    uint8_t     length;      // number of columns in the run
+    port_data_t mask;        // run bits, after shifting the port value down by port_shift
+} matrix_col_run_t;
+
+static pin_t            col_port_pins[MATRIX_COLS];  // one pin of each port holding column pins
+static uint8_t          col_port_count = 0;
+static matrix_col_run_t col_runs[MATRIX_COLS];
+static uint8_t          col_run_count  = 0;
+static bool             col_runs_valid = false;
+
+static void matrix_init_col_runs(void) {
+    col_port_count = 0;
+    col_run_count  = 0;
+    col_runs_valid = true;
+
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        pin_t pin = col_pins[col];
+        if (pin == NO_PIN) {
+            continue;
+        }
+
+        uint8_t bit = getPinPortBit(pin);
+        if (bit >= sizeof(port_data_t) * 8) {
+            // can't be represented in a port read, fall back to reading pin by pin
+            col_runs_valid = false;
+            return;
+        }
+
+        uint8_t port = 0;
+        while (port < col_port_count && getPinPort(col_port_pins[port]) != getPinPort(pin)) {
+            port++;
+        }
+        if (port == col_port_count) {
+            col_port_pins[col_port_count++] = pin;
+        }
+
+        // extend the previous run if this column follows on from it, otherwise start a new one
+        matrix_col_run_t *run = col_run_count ? &col_runs[col_run_count - 1] : NULL;
+        if (run && run->port == port && col == run->col_shift + run->length && bit == run->port_shift + run->length) {
+            run->length++;
+        } else {
+            run = &col_runs[col_run_count++];
+            *run = (matrix_col_run_t){.port = port, .port_shift = bit, .col_shift = col, .length = 1};
+        }
+        run->mask = (port_data_t)((1UL << run->length) - 1);
+    }
+}
+
+static matrix_row_t matrix_read_col_ports(void) {
+    port_data_t  port_values[MATRIX_COLS];
+    matrix_row_t current_row_value = 0;
+
+    // a single register read per port, inverted as a pressed key pulls its column low
+    for (uint8_t port = 0; port < col_port_count; port++) {
+        port_values[port] = (port_data_t)~readPort(col_port_pins[port]);
+    }
+
+    for (uint8_t i = 0; i < col_run_count; i++) {
+        const matrix_col_run_t *run = &col_runs[i];
+        current_row_value |= ((matrix_row_t)((port_values[run->port] >> run->port_shift) & run->mask)) << run->col_shift;
+    }
+
+    return current_row_value * MATRIX_ROW_SHIFTER;
+}
+#            endif
+
 static bool select_row(uint8_t row) {
     pin_t pin = row_pins[row];
     if (pin != NO_PIN) {
@@ -169,13 +268,20 @@ __attribute__((weak)) void matrix_read_cols_on_row(matrix_row_t current_matrix[]
     }
     matrix_output_select_delay();
 
-    // For each col...
-    matrix_row_t row_shifter = MATRIX_ROW_SHIFTER;
-    for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++, row_shifter <<= 1) {
-        uint8_t pin_state = readMatrixPin(col_pins[col_index]);
-
-        // Populate the matrix row with the state of the col pin
-        current_row_value |= pin_state ? 0 : row_shifter;
+#            ifdef MATRIX_READ_PORTS
+    if (col_runs_valid) {
+        current_row_value = matrix_read_col_ports();
+    } else
+#            endif
+    {
+        // For each col...
+        matrix_row_t row_shifter = MATRIX_ROW_SHIFTER;
+        for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++, row_shifter <<= 1) {
+            uint8_t pin_state = readMatrixPin(col_pins[col_index]);
+
+            // Populate the matrix row with the state of the col pin
+            current_row_value |= pin_state ? 0 : row_shifter;
+        }
     }
 
     // Unselect row
@@ -254,6 +360,177 @@ __attribute__((weak)) void matrix_read_rows_on_col(matrix_row_t current_matrix[]
 #    error DIODE_DIRECTION is not defined!
 #endif
 
+#ifdef MATRIX_IDLE_SLEEP_ENABLE
+static uint32_t idle_since       = 0;  // last time a key was down in either the raw or debounced matrix
+static uint32_t idle_wakeup_time    = 0;
+static bool     idle_wakeup_pending = false;
+
+/** \brief Take the time of the key press that woke the matrix
+ *
+ * Returns false if there was no wakeup since the last call, so only the first key event after a wakeup
+ * is stamped with it.
+ */
+bool matrix_idle_take_wakeup_time(uint32_t *time) {
+    if (!idle_wakeup_pending) {
+        return false;
+    }
+    idle_wakeup_pending = false;
+    *time               = idle_wakeup_time;
+    return true;
+}
+
+// While idle, every line that would be selected during a scan is driven low at once, so pressing any key
+// pulls one of the sense pins low. Returns false if some sense pins have to be polled.
+static bool matrix_idle_arm(void) {
+    bool all_armed = true;
+#    ifdef DIRECT_PINS
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (direct_pins[row][col] != NO_PIN) {
+                all_armed &= pin_wakeup_enable(direct_pins[row][col]);
+            }
+        }
+    }
+#    elif (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        select_row(row);
+    }
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        if (col_pins[col] != NO_PIN) {
+            all_armed &= pin_wakeup_enable(col_pins[col]);
+        }
+    }
+#    elif (DIODE_DIRECTION == ROW2COL)
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        select_col(col);
+    }
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        if (row_pins[row] != NO_PIN) {
+            all_armed &= pin_wakeup_enable(row_pins[row]);
+        }
+    }
+#    endif
+    matrix_output_select_delay();
+    return all_armed;
+}
+
+static void matrix_idle_disarm(void) {
+#    ifdef DIRECT_PINS
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (direct_pins[row][col] != NO_PIN) {
+                pin_wakeup_disable(direct_pins[row][col]);
+            }
+        }
+    }
+#    elif (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        if (col_pins[col] != NO_PIN) {
+            pin_wakeup_disable(col_pins[col]);
+        }
+    }
+    unselect_rows();
+#    elif (DIODE_DIRECTION == ROW2COL)
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        if (row_pins[row] != NO_PIN) {
+            pin_wakeup_disable(row_pins[row]);
+        }
+    }
+    unselect_cols();
+#    endif
+}
+
+static bool matrix_idle_key_down(void) {
+#    ifdef DIRECT_PINS
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (direct_pins[row][col] != NO_PIN && !readPin(direct_pins[row][col])) {
+                return true;
+            }
+        }
+    }
+#    elif (DIODE_DIRECTION == COL2ROW)
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        if (!readMatrixPin(col_pins[col])) {
+            return true;
+        }
+    }
+#    elif (DIODE_DIRECTION == ROW2COL)
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        if (!readMatrixPin(row_pins[row])) {
+            return true;
+        }
+    }
+#    endif
+    return false;
+}
+
+/** \brief Checks whether the main loop may sleep
+ *
+ * Sleeping stalls everything else in the main loop. Features it polls that can't wake it up would only be serviced
+ * every MATRIX_IDLE_SLEEP_MAX milliseconds, so the matrix never sleeps with them.
+ */
+static bool matrix_idle_sleep_allowed(void) {
+#    if defined(POINTING_DEVICE_ENABLE) || defined(RAW_ENABLE) || defined(MIDI_ENABLE) || defined(VIRTSER_ENABLE)
+    return false;
+#    elif defined(ENCODER_ENABLE) && defined(ENCODER_INTERRUPT_ENABLE)
+    return !encoder_needs_polling();
+#    elif defined(ENCODER_ENABLE)
+    return false;
+#    else
+    return true;
+#    endif
+}
+
+/** \brief Sleeps while no keys are down
+ *
+ * Returns on a key press, after MATRIX_IDLE_SLEEP_MAX milliseconds so the rest of the main loop still gets
+ * serviced, or when the next deferred executor is due, whichever comes first.
+ */
+static void matrix_idle_sleep(void) {
+    uint32_t start      = timer_read32();
+    uint32_t sleep_time = MATRIX_IDLE_SLEEP_MAX;
+#    ifdef DEFERRED_EXEC_ENABLE
+    uint32_t deadline;
+    if (deferred_exec_next_deadline(&deadline)) {
+        int32_t until_deadline = TIMER_DIFF_32(deadline, start);
+        if (until_deadline <= 0) {
+            return;
+        }
+        if ((uint32_t)until_deadline < sleep_time) {
+            sleep_time = until_deadline;
+        }
+    }
+#    endif
+
+    // A wakeup that never turned into a key event, e.g. a bounce rejected by debounce, is stale by now
+    idle_wakeup_pending = false;
+
+    bool     all_armed = matrix_idle_arm();
+    bool     woken     = false;
+    uint32_t edge_time = 0;
+    while (true) {
+        if (matrix_idle_key_down()) {
+            idle_wakeup_time    = woken ? edge_time : timer_read32();
+            idle_wakeup_pending = true;
+            idle_since          = idle_wakeup_time;
+            break;
+        }
+        if (woken) {
+            // Woken by something other than a key, such as an encoder, that needs the rest of the main loop
+            break;
+        }
+        uint32_t elapsed = timer_elapsed32(start);
+        if (elapsed >= sleep_time) {
+            break;
+        }
+        // Pins that can't raise a wakeup are polled every millisecond instead
+        woken = pin_wakeup_wait(all_armed ? sleep_time - elapsed : 1, &edge_time);
+    }
+    matrix_idle_disarm();
+}
+#endif
+
 void matrix_init(void) {
 #ifdef SPLIT_KEYBOARD
     split_pre_init();
@@ -286,6 +563,10 @@ void matrix_init(void) {
     thatHand = ROWS_PER_HAND - thisHand;
 #endif
 
+#if defined(MATRIX_READ_PORTS) && !defined(DIRECT_PINS) && defined(DIODE_DIRECTION) && (DIODE_DIRECTION == COL2ROW) && defined(MATRIX_ROW_PINS) && defined(MATRIX_COL_PINS)
+    matrix_init_col_runs();
+#endif
+
     // initialize key pins
     matrix_init_pins();
 
@@ -342,6 +623,12 @@ bool matrix_post_scan(void) {
 uint8_t matrix_scan(void) {
     matrix_row_t curr_matrix[MATRIX_ROWS] = {0};
 
+#ifdef MATRIX_IDLE_SLEEP_ENABLE
+    if (timer_elapsed32(idle_since) >= MATRIX_IDLE_TIMEOUT && matrix_idle_sleep_allowed()) {
+        matrix_idle_sleep();
+    }
+#endif
+
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
     // Set row, read cols
     for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
@@ -365,5 +652,14 @@ uint8_t matrix_scan(void) {
     debounce(raw_matrix, matrix, ROWS_PER_HAND, changed);
     matrix_scan_quantum();
 #endif
+
+#ifdef MATRIX_IDLE_SLEEP_ENABLE
+    for (uint8_t row = 0; row < ROWS_PER_HAND; row++) {
+        if (raw_matrix[row] || matrix[row]) {
+            idle_since = timer_read32();
+            break;
+        }
+    }
+#endif
     return (uint8_t)changed;
 }
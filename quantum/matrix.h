@@ -79,6 +79,11 @@ void matrix_slave_scan_kb(void);
 void matrix_slave_scan_user(void);
 #endif
 
+#ifdef MATRIX_IDLE_SLEEP_ENABLE
+/* time of the key press that woke the matrix from idle sleep, returned once per wakeup */
+bool matrix_idle_take_wakeup_time(uint32_t *time);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,6 +17,7 @@
  */
 
 #include "pointing_device.h"
+#include "timer.h"
 #include <string.h>
 #ifdef MOUSEKEY_ENABLE
 #    include "mousekey.h"
@@ -25,8 +26,41 @@
 #    error More than one rotation selected.  This is not supported.
 #endif
 
+// Send at most one report per poll of the mouse endpoint
+#ifndef POINTING_DEVICE_TASK_THROTTLE_MS
+#    if defined(USB_MOUSE_POLLING_INTERVAL_MS)
+#        define POINTING_DEVICE_TASK_THROTTLE_MS USB_MOUSE_POLLING_INTERVAL_MS
+#    elif defined(USB_POLLING_INTERVAL_MS)
+#        define POINTING_DEVICE_TASK_THROTTLE_MS USB_POLLING_INTERVAL_MS
+#    elif defined(PROTOCOL_VUSB)
+#        define POINTING_DEVICE_TASK_THROTTLE_MS 1
+#    else
+#        define POINTING_DEVICE_TASK_THROTTLE_MS 10
+#    endif
+#endif
+
 static report_mouse_t mouseReport = {};
 
+// Movement read from the sensor since the last report was sent
+static struct {
+    int16_t x;
+    int16_t y;
+    int16_t v;
+    int16_t h;
+} accumulator = {};
+
+static inline int16_t accumulate(int16_t total, int16_t delta) {
+    int32_t sum = (int32_t)total + delta;
+    return sum > INT16_MAX ? INT16_MAX : (sum < -INT16_MAX ? -INT16_MAX : sum);
+}
+
+// Moves as much of the accumulated movement as the report can hold out of the accumulator, the rest is carried over to the next report
+static inline int16_t take_accumulated(int16_t *total, int16_t limit) {
+    int16_t value = *total > limit ? limit : (*total < -limit ? -limit : *total);
+    *total -= value;
+    return value;
+}
+
 extern const pointing_device_driver_t pointing_device_driver;
 
 __attribute__((weak)) bool has_mouse_report_changed(report_mouse_t new, report_mouse_t old) { return memcmp(&new, &old, sizeof(new)); }
@@ -70,36 +104,59 @@ __attribute__((weak)) void pointing_device_send(void) {
     memcpy(&old_report, &mouseReport, sizeof(mouseReport));
 }
 
+void pointing_device_add_motion(int16_t x, int16_t y) {
+    // Support rotation of the sensor data
+#if defined(POINTING_DEVICE_ROTATION_90)
+    int16_t rotated_x = y, rotated_y = -x;
+#elif defined(POINTING_DEVICE_ROTATION_180)
+    int16_t rotated_x = -x, rotated_y = -y;
+#elif defined(POINTING_DEVICE_ROTATION_270)
+    int16_t rotated_x = -y, rotated_y = x;
+#else
+    int16_t rotated_x = x, rotated_y = y;
+#endif
+    // Support Inverting the X and Y Axises
+#if defined(POINTING_DEVICE_INVERT_X)
+    rotated_x = -rotated_x;
+#endif
+#if defined(POINTING_DEVICE_INVERT_Y)
+    rotated_y = -rotated_y;
+#endif
+    accumulator.x = accumulate(accumulator.x, rotated_x);
+    accumulator.y = accumulate(accumulator.y, rotated_y);
+}
+
 __attribute__((weak)) void pointing_device_task(void) {
+    static fast_timer_t last_send    = 0;
+    static uint8_t      last_buttons = 0;
+
     // Gather report info
 #ifdef POINTING_DEVICE_MOTION_PIN
     if (!readPin(POINTING_DEVICE_MOTION_PIN))
 #endif
+    {
         mouseReport = pointing_device_driver.get_report(mouseReport);
 
-        // Support rotation of the sensor data
-#if defined(POINTING_DEVICE_ROTATION_90) || defined(POINTING_DEVICE_ROTATION_180) || defined(POINTING_DEVICE_ROTATION_270)
-    int8_t x = mouseReport.x, y = mouseReport.y;
-#    if defined(POINTING_DEVICE_ROTATION_90)
-    mouseReport.x = y;
-    mouseReport.y = -x;
-#    elif defined(POINTING_DEVICE_ROTATION_180)
-    mouseReport.x = -x;
-    mouseReport.y = -y;
-#    elif defined(POINTING_DEVICE_ROTATION_270)
-    mouseReport.x = -y;
-    mouseReport.y = x;
-#    else
-#        error "How the heck did you get here?!"
-#    endif
-#endif
-    // Support Inverting the X and Y Axises
-#if defined(POINTING_DEVICE_INVERT_X)
-    mouseReport.x = -mouseReport.x;
-#endif
-#if defined(POINTING_DEVICE_INVERT_Y)
-    mouseReport.y = -mouseReport.y;
-#endif
+        // Drivers either report movement here or add it directly with pointing_device_add_motion()
+        pointing_device_add_motion(mouseReport.x, mouseReport.y);
+        accumulator.v = accumulate(accumulator.v, mouseReport.v);
+        accumulator.h = accumulate(accumulator.h, mouseReport.h);
+        mouseReport.x = 0;
+        mouseReport.y = 0;
+        mouseReport.v = 0;
+        mouseReport.h = 0;
+    }
+
+    // Button changes are sent right away, movement is collected until the host can take another report
+    if (mouseReport.buttons == last_buttons && timer_elapsed_fast(last_send) < POINTING_DEVICE_TASK_THROTTLE_MS) {
+        return;
+    }
+    last_send = timer_read_fast();
+
+    mouseReport.x = take_accumulated(&accumulator.x, MOUSE_REPORT_XY_MAX);
+    mouseReport.y = take_accumulated(&accumulator.y, MOUSE_REPORT_XY_MAX);
+    mouseReport.v = take_accumulated(&accumulator.v, 127);
+    mouseReport.h = take_accumulated(&accumulator.h, 127);
 
     // allow kb to intercept and modify report
     mouseReport = pointing_device_task_kb(mouseReport);
@@ -109,6 +166,7 @@ __attribute__((weak)) void pointing_device_task(void) {
     mouseReport.buttons            = mouseReport.buttons | mousekey_report.buttons;
 #endif
     pointing_device_send();
+    last_buttons = mouseReport.buttons;
 }
 
 report_mouse_t pointing_device_get_report(void) { return mouseReport; }
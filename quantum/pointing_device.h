@@ -78,6 +78,7 @@ void           pointing_device_send(void);
 report_mouse_t pointing_device_get_report(void);
 void           pointing_device_set_report(report_mouse_t newMouseReport);
 bool           has_mouse_report_changed(report_mouse_t new, report_mouse_t old);
+void           pointing_device_add_motion(int16_t x, int16_t y);
 uint16_t       pointing_device_get_cpi(void);
 void           pointing_device_set_cpi(uint16_t cpi);
 
@@ -22,9 +22,6 @@
 #include "timer.h"
 #include <stddef.h>
 
-// hid mouse reports cannot exceed -127 to 127, so constrain to that value
-#define constrain_hid(amt) ((amt) < -127 ? -127 : ((amt) > 127 ? 127 : (amt)))
-
 // get_report functions should probably be moved to their respective drivers.
 #if defined(POINTING_DEVICE_DRIVER_adns5050)
 report_mouse_t adns5050_get_report(report_mouse_t mouse_report) {
@@ -55,11 +52,8 @@ const pointing_device_driver_t pointing_device_driver = {
 report_mouse_t adns9800_get_report_driver(report_mouse_t mouse_report) {
     report_adns9800_t sensor_report = adns9800_get_report();
 
-    int8_t clamped_x = constrain_hid(sensor_report.x);
-    int8_t clamped_y = constrain_hid(sensor_report.y);
-
-    mouse_report.x = clamped_x;
-    mouse_report.y = clamped_y;
+    // the full 16-bit reading is accumulated, the pipeline splits it into reports
+    pointing_device_add_motion(sensor_report.x, sensor_report.y);
 
     return mouse_report;
 }
@@ -117,14 +111,12 @@ const pointing_device_driver_t pointing_device_driver = {
 report_mouse_t cirque_pinnacle_get_report(report_mouse_t mouse_report) {
     pinnacle_data_t touchData = cirque_pinnacle_read_data();
     static uint16_t x = 0, y = 0, mouse_timer = 0;
-    int8_t          report_x = 0, report_y = 0;
     static bool     is_z_down = false;
 
     cirque_pinnacle_scale_data(&touchData, cirque_pinnacle_get_scale(), cirque_pinnacle_get_scale());  // Scale coordinates to arbitrary X, Y resolution
 
     if (x && y && touchData.xValue && touchData.yValue) {
-        report_x = (int8_t)(touchData.xValue - x);
-        report_y = (int8_t)(touchData.yValue - y);
+        pointing_device_add_motion((int16_t)(touchData.xValue - x), (int16_t)(touchData.yValue - y));
     }
     x = touchData.xValue;
     y = touchData.yValue;
@@ -149,9 +141,6 @@ report_mouse_t cirque_pinnacle_get_report(report_mouse_t mouse_report) {
     if (timer_elapsed(mouse_timer) > (CIRQUE_PINNACLE_TOUCH_DEBOUNCE)) {
         mouse_timer = 0;
     }
-    mouse_report.x = report_x;
-    mouse_report.y = report_y;
-
     return mouse_report;
 }
 
@@ -170,7 +159,6 @@ report_mouse_t pimorono_trackball_get_report(report_mouse_t mouse_report) {
     static uint16_t     debounce      = 0;
     static uint8_t      error_count   = 0;
     pimoroni_data_t     pimoroni_data = {0};
-    static int16_t      x_offset = 0, y_offset = 0;
 
     if (error_count < PIMORONI_TRACKBALL_ERROR_COUNT && timer_elapsed_fast(throttle) >= PIMORONI_TRACKBALL_INTERVAL_MS) {
         i2c_status_t status = read_pimoroni_trackball(&pimoroni_data);
@@ -181,10 +169,9 @@ report_mouse_t pimorono_trackball_get_report(report_mouse_t mouse_report) {
             if (!(pimoroni_data.click & 128)) {
                 mouse_report.buttons = pointing_device_handle_buttons(mouse_report.buttons, false, POINTING_DEVICE_BUTTON1);
                 if (!debounce) {
-                    x_offset += pimoroni_trackball_get_offsets(pimoroni_data.right, pimoroni_data.left, PIMORONI_TRACKBALL_SCALE);
-                    y_offset += pimoroni_trackball_get_offsets(pimoroni_data.down, pimoroni_data.up, PIMORONI_TRACKBALL_SCALE);
-                    pimoroni_trackball_adapt_values(&mouse_report.x, &x_offset);
-                    pimoroni_trackball_adapt_values(&mouse_report.y, &y_offset);
+                    int16_t x_offset = pimoroni_trackball_get_offsets(pimoroni_data.right, pimoroni_data.left, PIMORONI_TRACKBALL_SCALE);
+                    int16_t y_offset = pimoroni_trackball_get_offsets(pimoroni_data.down, pimoroni_data.up, PIMORONI_TRACKBALL_SCALE);
+                    pointing_device_add_motion(x_offset, y_offset);
                 } else {
                     debounce--;
                 }
@@ -230,8 +217,7 @@ report_mouse_t pmw3360_get_report(report_mouse_t mouse_report) {
 #    endif
             MotionStart = timer_read();
         }
-        mouse_report.x = constrain_hid(data.dx);
-        mouse_report.y = constrain_hid(data.dy);
+        pointing_device_add_motion(data.dx, data.dy);
     }
 
     return mouse_report;
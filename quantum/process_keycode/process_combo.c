@@ -67,6 +67,23 @@ static queued_combo_t combo_buffer[COMBO_BUFFER_LENGTH];
 
 #define INCREMENT_MOD(i) i = (i + 1) % COMBO_BUFFER_LENGTH
 
+#ifdef COMBO_KEY_INDEX
+/* Keycode -> combo lookup, sorted by keycode and then by combo index. */
+typedef struct {
+    uint16_t keycode;
+    uint16_t combo_index;
+} combo_key_index_entry_t;
+static combo_key_index_entry_t combo_key_index[COMBO_KEY_INDEX_SIZE];
+static uint16_t                combo_key_index_size  = 0;
+static bool                    combo_key_index_built = false;
+static bool                    combo_key_index_valid = false;
+
+/* Combos whose state may need resetting on the next clear_combos(). */
+static uint16_t combo_touched[COMBO_TOUCHED_BUFFER_LENGTH];
+static uint8_t  combo_touched_size     = 0;
+static bool     combo_touched_overflow = false;
+#endif
+
 #define COMBO_KEY_POS ((keypos_t){.col = 254, .row = 254})
 
 #ifndef EXTRA_SHORT_COMBOS
@@ -171,14 +188,110 @@ static inline uint16_t _get_combo_term(uint16_t combo_index, combo_t *combo) {
     return COMBO_TERM;
 }
 
+#ifdef COMBO_KEY_INDEX
+/** \brief Build the keycode to combo index
+ *
+ * Called automatically before the first combo is processed. Call it again
+ * if key_combos[] or COMBO_LEN are modified at runtime. If the combos have
+ * more keys than COMBO_KEY_INDEX_SIZE, all combos are scanned linearly instead.
+ */
+void build_combo_index(void) {
+    combo_key_index_size  = 0;
+    combo_key_index_valid = true;
+    combo_key_index_built = true;
+
+    for (uint16_t idx = 0; idx < COMBO_LEN && combo_key_index_valid; ++idx) {
+        const uint16_t *keys = key_combos[idx].keys;
+        uint16_t        key;
+        for (uint8_t key_i = 0; (key = pgm_read_word(&keys[key_i])) != COMBO_END; key_i++) {
+            if (combo_key_index_size >= COMBO_KEY_INDEX_SIZE) {
+                dprintf("combo: index full, falling back to linear scan\n");
+                combo_key_index_valid = false;
+                break;
+            }
+
+            /* insertion sort, entries with equal keycodes stay in combo order */
+            uint16_t i = combo_key_index_size;
+            while (i > 0 && combo_key_index[i - 1].keycode > key) {
+                combo_key_index[i] = combo_key_index[i - 1];
+                i--;
+            }
+            if (i > 0 && combo_key_index[i - 1].keycode == key && combo_key_index[i - 1].combo_index == idx) {
+                /* same key listed twice in one combo, restore the shifted entries */
+                for (; i < combo_key_index_size; i++) {
+                    combo_key_index[i] = combo_key_index[i + 1];
+                }
+                continue;
+            }
+            combo_key_index[i] = (combo_key_index_entry_t){.keycode = key, .combo_index = idx};
+            combo_key_index_size++;
+        }
+    }
+}
+
+/** \brief Find the first index entry for a keycode
+ *
+ * Returns combo_key_index_size if no combo contains the keycode.
+ */
+static uint16_t find_combo_key_index(uint16_t keycode) {
+    uint16_t low = 0, high = combo_key_index_size;
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (combo_key_index[mid].keycode < keycode) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static void touch_combo(uint16_t combo_index) {
+    for (uint8_t i = 0; i < combo_touched_size; i++) {
+        if (combo_touched[i] == combo_index) {
+            return;
+        }
+    }
+    if (combo_touched_size < COMBO_TOUCHED_BUFFER_LENGTH) {
+        combo_touched[combo_touched_size++] = combo_index;
+    } else {
+        combo_touched_overflow = true;
+    }
+}
+#endif
+
 void clear_combos(void) {
     uint16_t index = 0;
     longest_term   = 0;
+#ifdef COMBO_KEY_INDEX
+    if (combo_key_index_valid && !combo_touched_overflow) {
+        /* Only combos that had a key pressed can have state. Active combos
+         * keep theirs, and stay tracked until they are released. */
+        uint8_t kept = 0;
+        for (uint8_t i = 0; i < combo_touched_size; i++) {
+            combo_t *combo = &key_combos[combo_touched[i]];
+            if (!COMBO_ACTIVE(combo)) {
+                RESET_COMBO_STATE(combo);
+            } else {
+                combo_touched[kept++] = combo_touched[i];
+            }
+        }
+        combo_touched_size = kept;
+        return;
+    }
+    combo_touched_size     = 0;
+    combo_touched_overflow = false;
+#endif
     for (index = 0; index < COMBO_LEN; ++index) {
         combo_t *combo = &key_combos[index];
         if (!COMBO_ACTIVE(combo)) {
             RESET_COMBO_STATE(combo);
         }
+#ifdef COMBO_KEY_INDEX
+        else {
+            touch_combo(index);
+        }
+#endif
     }
 }
 
@@ -366,6 +479,9 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
         uint16_t time = _get_combo_term(combo_index, combo);
         if (!COMBO_ACTIVE(combo)) {
             KEY_STATE_DOWN(combo->state, key_index);
+#ifdef COMBO_KEY_INDEX
+            touch_combo(combo_index);
+#endif
             if (longest_term < time) {
                 longest_term = time;
             }
@@ -487,11 +603,25 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     keycode = keymap_key_to_keycode(COMBO_ONLY_FROM_LAYER, record->event.key);
 #endif
 
-    for (uint16_t idx = 0; idx < COMBO_LEN; ++idx) {
-        combo_t *combo = &key_combos[idx];
-        is_combo_key |= process_single_combo(combo, keycode, record, idx);
-        no_combo_keys_pressed = no_combo_keys_pressed && (NO_COMBO_KEYS_ARE_DOWN || COMBO_ACTIVE(combo) || COMBO_DISABLED(combo));
+#ifdef COMBO_KEY_INDEX
+    if (!combo_key_index_built) {
+        build_combo_index();
     }
+    if (combo_key_index_valid) {
+        /* Only combos containing the keycode can be affected by it. */
+        for (uint16_t i = find_combo_key_index(keycode); i < combo_key_index_size && combo_key_index[i].keycode == keycode; i++) {
+            uint16_t idx   = combo_key_index[i].combo_index;
+            combo_t *combo = &key_combos[idx];
+            is_combo_key |= process_single_combo(combo, keycode, record, idx);
+            no_combo_keys_pressed = no_combo_keys_pressed && (NO_COMBO_KEYS_ARE_DOWN || COMBO_ACTIVE(combo) || COMBO_DISABLED(combo));
+        }
+    } else
+#endif
+        for (uint16_t idx = 0; idx < COMBO_LEN; ++idx) {
+            combo_t *combo = &key_combos[idx];
+            is_combo_key |= process_single_combo(combo, keycode, record, idx);
+            no_combo_keys_pressed = no_combo_keys_pressed && (NO_COMBO_KEYS_ARE_DOWN || COMBO_ACTIVE(combo) || COMBO_DISABLED(combo));
+        }
 
     if (record->event.pressed && is_combo_key) {
 #ifndef COMBO_NO_TIMER
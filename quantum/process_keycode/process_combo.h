@@ -37,6 +37,15 @@
 #    define COMBO_BUFFER_LENGTH 4
 #endif
 
+#ifdef COMBO_KEY_INDEX
+#    ifndef COMBO_KEY_INDEX_SIZE
+#        define COMBO_KEY_INDEX_SIZE 256
+#    endif
+#    ifndef COMBO_TOUCHED_BUFFER_LENGTH
+#        define COMBO_TOUCHED_BUFFER_LENGTH 16
+#    endif
+#endif
+
 typedef struct {
     const uint16_t *keys;
     uint16_t        keycode;
@@ -75,6 +84,10 @@ bool process_combo(uint16_t keycode, keyrecord_t *record);
 void combo_task(void);
 void process_combo_event(uint16_t combo_index, bool pressed);
 
+#ifdef COMBO_KEY_INDEX
+void build_combo_index(void);
+#endif
+
 void combo_enable(void);
 void combo_disable(void);
 void combo_toggle(void);
@@ -26,6 +26,10 @@
 #    define KEY_OVERRIDE_REPEAT_DELAY 500
 #endif
 
+#if defined(KEY_OVERRIDE_TRIGGER_INDEX) && !defined(KEY_OVERRIDE_TRIGGER_INDEX_SIZE)
+#    define KEY_OVERRIDE_TRIGGER_INDEX_SIZE 128
+#endif
+
 // For benchmarking the time it takes to call process_key_override on every key press (needs keyboard debugging enabled as well)
 // #define BENCH_KEY_OVERRIDE
 
@@ -241,138 +245,241 @@ static bool check_activation_event(const key_override_t *override, const bool ke
     }
 }
 
-/** Iterates through the list of key overrides and tries activating each, until it finds one that activates or reaches the end of overrides. Returns true if the key action for `keycode` should be sent */
-static bool try_activating_override(const uint16_t keycode, const uint8_t layer, const bool key_down, const bool is_mod, const uint8_t active_mods, bool *activated) {
-    if (key_overrides == NULL) {
-        return true;
+/** Tries activating a single key override. Returns true if it was activated, in which case `send_key_action` is set to whether the key action for `keycode` should be sent */
+static bool try_activating_single_override(const key_override_t *const override, const uint16_t keycode, const uint8_t layer, const bool key_down, const bool is_mod, const uint8_t active_mods, bool *send_key_action) {
+    // Fast, but not full mods check. Most key presses will not have any mods down, and most overrides will require mods. Hence here we filter overrides that require mods to be down while no mods are down
+    if (active_mods == 0 && override->trigger_mods != 0) {
+        key_override_printf("Not activating override: Modifiers don't match\n");
+        return false;
     }
 
-    for (uint8_t i = 0;; i++) {
-        const key_override_t *const override = key_overrides[i];
+    // Check layer
+    if ((override->layers & (1 << layer)) == 0) {
+        key_override_printf("Not activating override: Not set to activate on pressed layer\n");
+        return false;
+    }
 
-        // End of array
-        if (override == NULL) {
-            break;
-        }
+    // Check allowed activation events
+    if (!check_activation_event(override, key_down, is_mod)) {
+        key_override_printf("Not activating override: Activation event not allowed\n");
+        return false;
+    }
 
-        // Fast, but not full mods check. Most key presses will not have any mods down, and most overrides will require mods. Hence here we filter overrides that require mods to be down while no mods are down
-        if (active_mods == 0 && override->trigger_mods != 0) {
-            key_override_printf("Not activating override: Modifiers don't match\n");
-            continue;
-        }
+    const bool is_trigger = override->trigger == keycode;
 
-        // Check layer
-        if ((override->layers & (1 << layer)) == 0) {
-            key_override_printf("Not activating override: Not set to activate on pressed layer\n");
-            continue;
-        }
+    // Check if trigger lifted. This is a small optimization in order to skip the remaining checks
+    if (is_trigger && !key_down) {
+        key_override_printf("Not activating override: Trigger lifted\n");
+        return false;
+    }
 
-        // Check allowed activation events
-        if (!check_activation_event(override, key_down, is_mod)) {
-            key_override_printf("Not activating override: Activation event not allowed\n");
-            continue;
-        }
+    // If the trigger is KC_NO it means 'no key', so only the required modifiers need to be down.
+    const bool no_trigger = override->trigger == KC_NO;
 
-        const bool is_trigger = override->trigger == keycode;
+    // Check if aleady active
+    if (override == active_override) {
+        key_override_printf("Not activating override: Alerady actived\n");
+        return false;
+    }
 
-        // Check if trigger lifted. This is a small optimization in order to skip the remaining checks
-        if (is_trigger && !key_down) {
-            key_override_printf("Not activating override: Trigger lifted\n");
-            continue;
-        }
+    // Check if enabled
+    if (override->enabled != NULL && !((*(override->enabled) & 1))) {
+        key_override_printf("Not activating override: Not enabled\n");
+        return false;
+    }
 
-        // If the trigger is KC_NO it means 'no key', so only the required modifiers need to be down.
-        const bool no_trigger = override->trigger == KC_NO;
+    // Check mods precisely
+    if (!key_override_matches_active_modifiers(override, active_mods)) {
+        key_override_printf("Not activating override: Modifiers don't match\n");
+        return false;
+    }
 
-        // Check if aleady active
-        if (override == active_override) {
-            key_override_printf("Not activating override: Alerady actived\n");
-            continue;
-        }
+    // Check if trigger key is down.
+    const bool trigger_down = is_trigger && key_down;
 
-        // Check if enabled
-        if (override->enabled != NULL && !((*(override->enabled) & 1))) {
-            key_override_printf("Not activating override: Not enabled\n");
-            continue;
-        }
+    // At this point, all requirements for activation are checked, except whether the trigger key is pressed. Now we check if the required trigger is down
+    // If no trigger key is required, yes.
+    // If the trigger was just pressed, yes.
+    // If the last non-mod key that was pressed down is the trigger key, yes.
+    bool should_activate = no_trigger || trigger_down || last_key_down == override->trigger;
 
-        // Check mods precisely
-        if (!key_override_matches_active_modifiers(override, active_mods)) {
-            key_override_printf("Not activating override: Modifiers don't match\n");
-            continue;
-        }
+    if (!should_activate) {
+        key_override_printf("Not activating override. Trigger not down\n");
+        return false;
+    }
+
+    key_override_printf("Activating override\n");
 
-        // Check if trigger key is down.
-        const bool trigger_down = is_trigger && key_down;
+    clear_active_override(false);
 
-        // At this point, all requirements for activation are checked, except whether the trigger key is pressed. Now we check if the required trigger is down
-        // If no trigger key is required, yes.
-        // If the trigger was just pressed, yes.
-        // If the last non-mod key that was pressed down is the trigger key, yes.
-        bool should_activate = no_trigger || trigger_down || last_key_down == override->trigger;
+    active_override                 = override;
+    active_override_trigger_is_down = true;
 
-        if (!should_activate) {
-            key_override_printf("Not activating override. Trigger not down\n");
-            continue;
+    set_suppressed_override_mods(override->suppressed_mods);
+
+    if (!trigger_down && !no_trigger) {
+        // When activating a key override the trigger is is always unregistered. In the case where the key that newly pressed is not the trigger key, we have to explicitly remove the trigger key from the keyboard report. If the trigger was just pressed down we simply suppress the event which also has the effect of the trigger key not being registered in the keyboard report.
+        if (IS_KEY(override->trigger)) {
+            del_key(override->trigger);
+        } else {
+            unregister_code(override->trigger);
         }
+    }
 
-        key_override_printf("Activating override\n");
+    const uint16_t mod_free_replacement = clear_mods_from(override->replacement);
 
-        clear_active_override(false);
+    bool register_replacement = mod_free_replacement != KC_NO &&    // KC_NO is never registered
+                                mod_free_replacement < SAFE_RANGE;  // Custom keycodes are never registered
 
-        active_override                 = override;
-        active_override_trigger_is_down = true;
+    // Try firing the custom handler
+    if (override->custom_action != NULL) {
+        register_replacement &= override->custom_action(true, override->context);
+    }
 
-        set_suppressed_override_mods(override->suppressed_mods);
+    if (register_replacement) {
+        const uint8_t override_mods = extract_mod_bits(override->replacement);
+        set_weak_override_mods(override_mods);
 
-        if (!trigger_down && !no_trigger) {
-            // When activating a key override the trigger is is always unregistered. In the case where the key that newly pressed is not the trigger key, we have to explicitly remove the trigger key from the keyboard report. If the trigger was just pressed down we simply suppress the event which also has the effect of the trigger key not being registered in the keyboard report.
-            if (IS_KEY(override->trigger)) {
-                del_key(override->trigger);
+        // If this is a modifier event that activates the key override we _always_ defer the actual full activation of the override
+        if (is_mod) {
+            key_override_printf("Deferring register replacement key\n");
+            schedule_deferred_register(mod_free_replacement);
+            send_keyboard_report();
+        } else {
+            if (IS_KEY(mod_free_replacement)) {
+                add_key(mod_free_replacement);
             } else {
-                unregister_code(override->trigger);
+                key_override_printf("NOT KEY 2\n");
+                send_keyboard_report();
+                // On macOS there seems to be a race condition when it comes to the keyboard report and consumer keycodes. It seems the OS may recognize a consumer keycode before an updated keyboard report, even if the keyboard report is actually sent before the consumer key. I assume it is some sort of race condition because it happens infrequently and very irregularly. Waiting for about at least 10ms between sending the keyboard report and sending the consumer code has shown to fix this.
+                wait_ms(10);
+                register_code(mod_free_replacement);
             }
         }
+    } else {
+        // If not registering the replacement key send keyboard report to update the unregistered keys.
+        send_keyboard_report();
+    }
 
-        const uint16_t mod_free_replacement = clear_mods_from(override->replacement);
+    // If the trigger is down, suppress the event so that it does not get added to the keyboard report.
+    *send_key_action = !trigger_down;
 
-        bool register_replacement = mod_free_replacement != KC_NO &&    // KC_NO is never registered
-                                    mod_free_replacement < SAFE_RANGE;  // Custom keycodes are never registered
+    return true;
+}
 
-        // Try firing the custom handler
-        if (override->custom_action != NULL) {
-            register_replacement &= override->custom_action(true, override->context);
+#ifdef KEY_OVERRIDE_TRIGGER_INDEX
+// Indices into key_overrides, sorted by trigger keycode and then by position in key_overrides
+static uint8_t                trigger_index[KEY_OVERRIDE_TRIGGER_INDEX_SIZE];
+static uint8_t                trigger_index_size      = 0;
+static const key_override_t **trigger_index_overrides = NULL;
+static bool                   trigger_index_valid     = false;
+
+/** Builds the trigger index for the current key_overrides array. Falls back to the linear scan if there are more overrides than fit in the index */
+static void build_trigger_index(void) {
+    trigger_index_overrides = key_overrides;
+    trigger_index_size      = 0;
+    trigger_index_valid     = true;
+
+    for (uint8_t i = 0; key_overrides[i] != NULL; i++) {
+        if (trigger_index_size >= KEY_OVERRIDE_TRIGGER_INDEX_SIZE || i == UINT8_MAX) {
+            dprintf("Key override trigger index full, falling back to linear scan\n");
+            trigger_index_valid = false;
+            return;
         }
 
-        if (register_replacement) {
-            const uint8_t override_mods = extract_mod_bits(override->replacement);
-            set_weak_override_mods(override_mods);
+        // Insertion sort, overrides with equal triggers keep their order
+        const uint16_t trigger = key_overrides[i]->trigger;
+        uint8_t        j       = trigger_index_size;
+        while (j > 0 && key_overrides[trigger_index[j - 1]]->trigger > trigger) {
+            trigger_index[j] = trigger_index[j - 1];
+            j--;
+        }
+        trigger_index[j] = i;
+        trigger_index_size++;
+    }
+}
 
-            // If this is a modifier event that activates the key override we _always_ defer the actual full activation of the override
-            if (is_mod) {
-                key_override_printf("Deferring register replacement key\n");
-                schedule_deferred_register(mod_free_replacement);
-                send_keyboard_report();
-            } else {
-                if (IS_KEY(mod_free_replacement)) {
-                    add_key(mod_free_replacement);
-                } else {
-                    key_override_printf("NOT KEY 2\n");
-                    send_keyboard_report();
-                    // On macOS there seems to be a race condition when it comes to the keyboard report and consumer keycodes. It seems the OS may recognize a consumer keycode before an updated keyboard report, even if the keyboard report is actually sent before the consumer key. I assume it is some sort of race condition because it happens infrequently and very irregularly. Waiting for about at least 10ms between sending the keyboard report and sending the consumer code has shown to fix this.
-                    wait_ms(10);
-                    register_code(mod_free_replacement);
+/** Finds the range of trigger index entries with the given trigger keycode */
+static void find_trigger_range(const uint16_t trigger, uint8_t *begin, uint8_t *end) {
+    uint8_t low = 0, high = trigger_index_size;
+    while (low < high) {
+        const uint8_t mid = low + (high - low) / 2;
+        if (key_overrides[trigger_index[mid]]->trigger < trigger) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    *begin = low;
+    while (low < trigger_index_size && key_overrides[trigger_index[low]]->trigger == trigger) {
+        low++;
+    }
+    *end = low;
+}
+#endif
+
+/** Iterates through the list of key overrides and tries activating each, until it finds one that activates or reaches the end of overrides. Returns true if the key action for `keycode` should be sent */
+static bool try_activating_override(const uint16_t keycode, const uint8_t layer, const bool key_down, const bool is_mod, const uint8_t active_mods, bool *activated) {
+    if (key_overrides == NULL) {
+        return true;
+    }
+
+    bool send_key_action = true;
+
+#ifdef KEY_OVERRIDE_TRIGGER_INDEX
+    if (trigger_index_overrides != key_overrides) {
+        build_trigger_index();
+    }
+
+    if (trigger_index_valid) {
+        // Only overrides without a trigger, or triggered by the current or the last pressed key can activate. Walk these three buckets merged back into key_overrides order, so that the first matching override wins just like in the linear scan.
+        uint8_t begin[3], end[3];
+        find_trigger_range(KC_NO, &begin[0], &end[0]);
+        find_trigger_range(keycode, &begin[1], &end[1]);
+        find_trigger_range(last_key_down, &begin[2], &end[2]);
+        if (keycode == KC_NO) {
+            end[1] = begin[1];
+        }
+        if (last_key_down == KC_NO || last_key_down == keycode) {
+            end[2] = begin[2];
+        }
+
+        while (true) {
+            int8_t bucket = -1;
+            for (uint8_t b = 0; b < 3; b++) {
+                if (begin[b] < end[b] && (bucket < 0 || trigger_index[begin[b]] < trigger_index[begin[bucket]])) {
+                    bucket = b;
                 }
             }
-        } else {
-            // If not registering the replacement key send keyboard report to update the unregistered keys.
-            send_keyboard_report();
+            if (bucket < 0) {
+                break;
+            }
+
+            const key_override_t *const override = key_overrides[trigger_index[begin[bucket]++]];
+            if (try_activating_single_override(override, keycode, layer, key_down, is_mod, active_mods, &send_key_action)) {
+                *activated = true;
+                return send_key_action;
+            }
         }
 
-        *activated = true;
+        *activated = false;
 
-        // If the trigger is down, suppress the event so that it does not get added to the keyboard report.
-        return !trigger_down;
+        return true;
+    }
+#endif
+
+    for (uint8_t i = 0;; i++) {
+        const key_override_t *const override = key_overrides[i];
+
+        // End of array
+        if (override == NULL) {
+            break;
+        }
+
+        if (try_activating_single_override(override, keycode, layer, key_down, is_mod, active_mods, &send_key_action)) {
+            *activated = true;
+            return send_key_action;
+        }
     }
 
     *activated = false;
@@ -99,6 +99,7 @@ void unregister_code16(uint16_t code) {
 void tap_code16(uint16_t code) {
     register_code16(code);
 #if TAP_CODE_DELAY > 0
+    flush_keyboard_report_batch();
     wait_ms(TAP_CODE_DELAY);
 #endif
     unregister_code16(code);
@@ -135,6 +136,8 @@ void reset_keyboard(void) {
 #ifdef HAPTIC_ENABLE
     haptic_shutdown();
 #endif
+    // Don't lose pending settings changes
+    eeconfig_flush();
     bootloader_jump();
 }
 
@@ -488,6 +491,9 @@ __attribute__((weak)) void suspend_power_down_user(void) {}
 __attribute__((weak)) void suspend_power_down_kb(void) { suspend_power_down_user(); }
 
 void suspend_power_down_quantum(void) {
+    // Write back pending settings changes before the host may cut power
+    eeconfig_flush();
+
 #ifndef NO_SUSPEND_POWER_DOWN
 // Turn off backlight
 #    ifdef BACKLIGHT_ENABLE
@@ -7,14 +7,16 @@ bool GRADIENT_LEFT_RIGHT(effect_params_t* params) {
 
     HSV     hsv   = rgb_matrix_config.hsv;
     uint8_t scale = scale8(64, rgb_matrix_config.speed);
+
+    rgb_matrix_hsv_batch_t batch = {0};
     for (uint8_t i = led_min; i < led_max; i++) {
         RGB_MATRIX_TEST_LED_FLAGS();
         // The x range will be 0..224, map this to 0..7
         // Relies on hue being 8-bit and wrapping
-        hsv.h   = rgb_matrix_config.hsv.h + (scale * g_led_config.point[i].x >> 5);
-        RGB rgb = rgb_matrix_hsv_to_rgb(hsv);
-        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
+        hsv.h = rgb_matrix_config.hsv.h + (scale * g_led_config.point[i].x >> 5);
+        rgb_matrix_hsv_batch_add(&batch, i, hsv);
     }
+    rgb_matrix_hsv_batch_flush(&batch);
     return rgb_matrix_check_finished_leds(led_max);
 }
 
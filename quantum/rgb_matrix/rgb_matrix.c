@@ -25,13 +25,57 @@
 
 #include <lib/lib8tion/lib8tion.h>
 
+#ifdef RGB_MATRIX_THREADED
+#    include <ch.h>
+#endif
+
 #ifndef RGB_MATRIX_CENTER
 const led_point_t k_rgb_matrix_center = {112, 32};
 #else
 const led_point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 #endif
 
-__attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv); }
+static RGB rgb_matrix_hsv_to_rgb_default(HSV hsv) { return hsv_to_rgb(hsv); }
+RGB        rgb_matrix_hsv_to_rgb(HSV hsv) __attribute__((weak, alias("rgb_matrix_hsv_to_rgb_default")));
+
+// Effects render whole frames through this, the batch kernel is only used while rgb_matrix_hsv_to_rgb() isn't overridden
+__attribute__((weak)) void rgb_matrix_hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    if (rgb_matrix_hsv_to_rgb == rgb_matrix_hsv_to_rgb_default) {
+        hsv_to_rgb_batch(hsv, rgb, count);
+        return;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        rgb[i] = rgb_matrix_hsv_to_rgb(hsv[i]);
+    }
+}
+
+#ifndef RGB_MATRIX_HSV_BATCH_SIZE
+#    define RGB_MATRIX_HSV_BATCH_SIZE 16
+#endif
+
+// Effects queue up the colors of a frame and have them converted to RGB a batch at a time
+typedef struct {
+    uint8_t count;
+    uint8_t index[RGB_MATRIX_HSV_BATCH_SIZE];
+    HSV     hsv[RGB_MATRIX_HSV_BATCH_SIZE];
+} rgb_matrix_hsv_batch_t;
+
+static void rgb_matrix_hsv_batch_flush(rgb_matrix_hsv_batch_t *batch) {
+    RGB rgb[RGB_MATRIX_HSV_BATCH_SIZE];
+    rgb_matrix_hsv_to_rgb_batch(batch->hsv, rgb, batch->count);
+    for (uint8_t i = 0; i < batch->count; i++) {
+        rgb_matrix_set_color(batch->index[i], rgb[i].r, rgb[i].g, rgb[i].b);
+    }
+    batch->count = 0;
+}
+
+static inline void rgb_matrix_hsv_batch_add(rgb_matrix_hsv_batch_t *batch, uint8_t index, HSV hsv) {
+    batch->index[batch->count] = index;
+    batch->hsv[batch->count]   = hsv;
+    if (++batch->count == RGB_MATRIX_HSV_BATCH_SIZE) {
+        rgb_matrix_hsv_batch_flush(batch);
+    }
+}
 
 // Generic effect runners
 #include "rgb_matrix_runners.inc"
@@ -139,6 +183,28 @@ static last_hit_t last_hit_buffer;
 const uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;
 #endif
 
+#ifdef RGB_MATRIX_THREADED
+// Effects render into the back buffer, which is handed to the driver in one go once the frame is complete, so the
+// driver buffers are only ever touched from the render thread.
+static RGB rgb_back_buffer[DRIVER_LED_TOTAL];
+
+// Key hits are handed over from the main thread through a single producer, single consumer queue. The head is only
+// written by the main thread, the tail only by the render thread.
+typedef struct {
+    uint8_t row;
+    uint8_t col;
+    bool    pressed;
+} rgb_hit_event_t;
+
+_Static_assert((RGB_MATRIX_HIT_QUEUE_SIZE & (RGB_MATRIX_HIT_QUEUE_SIZE - 1)) == 0 && RGB_MATRIX_HIT_QUEUE_SIZE <= 128, "RGB_MATRIX_HIT_QUEUE_SIZE must be a power of two no larger than 128");
+
+static rgb_hit_event_t  rgb_hit_queue[RGB_MATRIX_HIT_QUEUE_SIZE];
+static uint8_t          rgb_hit_queue_head  = 0;
+static uint8_t          rgb_hit_queue_tail  = 0;
+static volatile bool    rgb_restart_request = false;
+static volatile bool    rgb_blank_request   = false;
+#endif  // RGB_MATRIX_THREADED
+
 EECONFIG_DEBOUNCE_HELPER(rgb_matrix, EECONFIG_RGB_MATRIX, rgb_matrix_config);
 
 void eeconfig_update_rgb_matrix(void) { eeconfig_flush_rgb_matrix(true); }
@@ -176,22 +242,38 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
     return led_count;
 }
 
+#ifdef RGB_MATRIX_THREADED
+void rgb_matrix_update_pwm_buffers(void) {
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        rgb_matrix_driver.set_color(i, rgb_back_buffer[i].r, rgb_back_buffer[i].g, rgb_back_buffer[i].b);
+    }
+    rgb_matrix_driver.flush();
+}
+
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+    if (index >= 0 && index < DRIVER_LED_TOTAL) {
+        rgb_back_buffer[index] = (RGB){.r = red, .g = green, .b = blue};
+    }
+}
+
+void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) rgb_matrix_set_color(i, red, green, blue);
+}
+#else
 void rgb_matrix_update_pwm_buffers(void) { rgb_matrix_driver.flush(); }
 
 void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color(index, red, green, blue); }
 
 void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
-#if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+#    if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
     for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) rgb_matrix_set_color(i, red, green, blue);
-#else
+#    else
     rgb_matrix_driver.set_color_all(red, green, blue);
-#endif
+#    endif
 }
+#endif  // RGB_MATRIX_THREADED
 
-void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed) {
-#ifndef RGB_MATRIX_SPLIT
-    if (!is_keyboard_master()) return;
-#endif
+static void rgb_matrix_process_hit(uint8_t row, uint8_t col, bool pressed) {
 #if RGB_DISABLE_TIMEOUT > 0
     rgb_anykey_timer = 0;
 #endif  // RGB_DISABLE_TIMEOUT > 0
@@ -234,6 +316,37 @@ void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed) {
 #endif  // defined(RGB_MATRIX_FRAMEBUFFER_EFFECTS) && defined(ENABLE_RGB_MATRIX_TYPING_HEATMAP)
 }
 
+#ifdef RGB_MATRIX_THREADED
+static void rgb_hit_queue_drain(void) {
+    uint8_t tail = rgb_hit_queue_tail;
+    uint8_t head = __atomic_load_n(&rgb_hit_queue_head, __ATOMIC_ACQUIRE);
+    while (tail != head) {
+        rgb_hit_event_t *event = &rgb_hit_queue[tail % RGB_MATRIX_HIT_QUEUE_SIZE];
+        rgb_matrix_process_hit(event->row, event->col, event->pressed);
+        tail++;
+    }
+    __atomic_store_n(&rgb_hit_queue_tail, tail, __ATOMIC_RELEASE);
+}
+#endif  // RGB_MATRIX_THREADED
+
+void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed) {
+#ifndef RGB_MATRIX_SPLIT
+    if (!is_keyboard_master()) return;
+#endif
+#ifdef RGB_MATRIX_THREADED
+    uint8_t head = rgb_hit_queue_head;
+    uint8_t tail = __atomic_load_n(&rgb_hit_queue_tail, __ATOMIC_ACQUIRE);
+    if ((uint8_t)(head - tail) >= RGB_MATRIX_HIT_QUEUE_SIZE) {
+        // Queue is full, the render thread has fallen behind; drop the hit rather than wait for it
+        return;
+    }
+    rgb_hit_queue[head % RGB_MATRIX_HIT_QUEUE_SIZE] = (rgb_hit_event_t){.row = row, .col = col, .pressed = pressed};
+    __atomic_store_n(&rgb_hit_queue_head, (uint8_t)(head + 1), __ATOMIC_RELEASE);
+#else
+    rgb_matrix_process_hit(row, col, pressed);
+#endif
+}
+
 void rgb_matrix_test(void) {
     // Mask out bits 4 and 5
     // Increase the factor to make the test animation slower (and reduce to make it faster)
@@ -294,7 +407,9 @@ static void rgb_task_timers(void) {
 }
 
 static void rgb_task_sync(void) {
+#ifndef RGB_MATRIX_THREADED
     eeconfig_flush_rgb_matrix(false);
+#endif
     // next task
     if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
 }
@@ -385,7 +500,7 @@ static void rgb_task_flush(uint8_t effect) {
     rgb_task_state = SYNCING;
 }
 
-void rgb_matrix_task(void) {
+static void rgb_task_step(void) {
     rgb_task_timers();
 
     // Ideally we would also stop sending zeros to the LED driver PWM buffers
@@ -418,6 +533,51 @@ void rgb_matrix_task(void) {
     }
 }
 
+#ifdef RGB_MATRIX_THREADED
+static THD_WORKING_AREA(waRgbMatrixThread, RGB_MATRIX_THREAD_STACK_SIZE);
+static THD_FUNCTION(RgbMatrixThread, arg) {
+    (void)arg;
+    chRegSetThreadName("rgb_matrix");
+
+    while (true) {
+        if (rgb_blank_request) {
+            rgb_task_render(0);  // turn off all LEDs when suspending
+            rgb_task_flush(0);   // and actually flash led state to LEDs
+            rgb_blank_request = false;
+        }
+
+        // Only this thread runs the task state machine, other threads ask for a restart through the flag
+        if (rgb_restart_request) {
+            rgb_restart_request = false;
+            rgb_task_state      = STARTING;
+        }
+
+        rgb_hit_queue_drain();
+        rgb_task_step();
+
+        if (rgb_task_state == SYNCING) {
+            // Nothing to do until the next frame is due
+            uint32_t elapsed = sync_timer_elapsed32(g_rgb_timer);
+            chThdSleepMilliseconds(elapsed < RGB_MATRIX_LED_FLUSH_LIMIT ? RGB_MATRIX_LED_FLUSH_LIMIT - elapsed : 1);
+        } else {
+            // Hand the CPU back to the main loop after every step
+            chThdYield();
+        }
+    }
+}
+
+void rgb_matrix_task(void) {
+    // Rendering happens on its own thread, only settings are persisted from here
+    eeconfig_flush_rgb_matrix(false);
+
+    // The main loop never blocks on its own, so let the render thread take its next step. This returns straight
+    // away while the render thread is sleeping or waiting for the LED driver.
+    chThdYield();
+}
+#else
+void rgb_matrix_task(void) { rgb_task_step(); }
+#endif  // RGB_MATRIX_THREADED
+
 void rgb_matrix_indicators(void) {
     rgb_matrix_indicators_kb();
     rgb_matrix_indicators_user();
@@ -476,23 +636,47 @@ void rgb_matrix_init(void) {
         eeconfig_update_rgb_matrix_default();
     }
     eeconfig_debug_rgb_matrix();  // display current eeprom values
+
+#ifdef RGB_MATRIX_THREADED
+    chThdCreateStatic(waRgbMatrixThread, sizeof(waRgbMatrixThread), RGB_MATRIX_THREAD_PRIORITY, RgbMatrixThread, NULL);
+#endif
 }
 
 void rgb_matrix_set_suspend_state(bool state) {
 #ifdef RGB_DISABLE_WHEN_USB_SUSPENDED
+#    ifdef RGB_MATRIX_THREADED
+    if (state && !suspend_state) {  // only run if turning off, and only once
+        suspend_state     = state;
+        rgb_blank_request = true;
+        // the render thread turns off the LEDs, give it the time to do so
+        for (uint8_t i = 0; i < 100 && rgb_blank_request; i++) {
+            chThdSleepMilliseconds(1);
+        }
+    }
+#    else
     if (state && !suspend_state) {  // only run if turning off, and only once
         rgb_task_render(0);         // turn off all LEDs when suspending
         rgb_task_flush(0);          // and actually flash led state to LEDs
     }
+#    endif
     suspend_state = state;
 #endif
 }
 
 bool rgb_matrix_get_suspend_state(void) { return suspend_state; }
 
+// Starts rendering a new frame, e.g. after the mode changed
+static void rgb_task_restart(void) {
+#ifdef RGB_MATRIX_THREADED
+    rgb_restart_request = true;
+#else
+    rgb_task_state = STARTING;
+#endif
+}
+
 void rgb_matrix_toggle_eeprom_helper(bool write_to_eeprom) {
     rgb_matrix_config.enable ^= 1;
-    rgb_task_state = STARTING;
+    rgb_task_restart();
     eeconfig_flag_rgb_matrix(write_to_eeprom);
     dprintf("rgb matrix toggle [%s]: rgb_matrix_config.enable = %u\n", (write_to_eeprom) ? "EEPROM" : "NOEEPROM", rgb_matrix_config.enable);
 }
@@ -505,7 +689,7 @@ void rgb_matrix_enable(void) {
 }
 
 void rgb_matrix_enable_noeeprom(void) {
-    if (!rgb_matrix_config.enable) rgb_task_state = STARTING;
+    if (!rgb_matrix_config.enable) rgb_task_restart();
     rgb_matrix_config.enable = 1;
 }
 
@@ -515,7 +699,7 @@ void rgb_matrix_disable(void) {
 }
 
 void rgb_matrix_disable_noeeprom(void) {
-    if (rgb_matrix_config.enable) rgb_task_state = STARTING;
+    if (rgb_matrix_config.enable) rgb_task_restart();
     rgb_matrix_config.enable = 0;
 }
 
@@ -532,7 +716,7 @@ void rgb_matrix_mode_eeprom_helper(uint8_t mode, bool write_to_eeprom) {
     } else {
         rgb_matrix_config.mode = mode;
     }
-    rgb_task_state = STARTING;
+    rgb_task_restart();
     eeconfig_flag_rgb_matrix(write_to_eeprom);
     dprintf("rgb matrix mode [%s]: %u\n", (write_to_eeprom) ? "EEPROM" : "NOEEPROM", rgb_matrix_config.mode);
 }
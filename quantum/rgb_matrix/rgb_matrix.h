@@ -46,6 +46,21 @@
 #    define RGB_MATRIX_LED_FLUSH_LIMIT 16
 #endif
 
+#ifdef RGB_MATRIX_THREADED
+#    ifndef PROTOCOL_CHIBIOS
+#        error "RGB_MATRIX_THREADED is only supported on ChibiOS"
+#    endif
+#    ifndef RGB_MATRIX_THREAD_PRIORITY
+#        define RGB_MATRIX_THREAD_PRIORITY NORMALPRIO
+#    endif
+#    ifndef RGB_MATRIX_THREAD_STACK_SIZE
+#        define RGB_MATRIX_THREAD_STACK_SIZE 1024
+#    endif
+#    ifndef RGB_MATRIX_HIT_QUEUE_SIZE
+#        define RGB_MATRIX_HIT_QUEUE_SIZE 16
+#    endif
+#endif
+
 #ifndef RGB_MATRIX_LED_PROCESS_LIMIT
 #    define RGB_MATRIX_LED_PROCESS_LIMIT (DRIVER_LED_TOTAL + 4) / 5
 #endif
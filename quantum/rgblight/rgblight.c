@@ -178,7 +178,7 @@ void rgblight_check_config(void) {
 
 uint32_t eeconfig_read_rgblight(void) {
 #ifdef EEPROM_ENABLE
-    return eeprom_read_dword(EECONFIG_RGBLIGHT);
+    return eeconfig_read_dword(EECONFIG_RGBLIGHT);
 #else
     return 0;
 #endif
@@ -187,7 +187,7 @@ uint32_t eeconfig_read_rgblight(void) {
 void eeconfig_update_rgblight(uint32_t val) {
 #ifdef EEPROM_ENABLE
     rgblight_check_config();
-    eeprom_update_dword(EECONFIG_RGBLIGHT, val);
+    eeconfig_update_dword(EECONFIG_RGBLIGHT, val);
 #endif
 }
 
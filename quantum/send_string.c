@@ -173,6 +173,7 @@ void send_string_with_delay(const char *str, uint8_t interval) {
                     ms += keycode - '0';
                     keycode = *(++str);
                 }
+                flush_keyboard_report_batch();
                 while (ms--) wait_ms(1);
             }
         } else {
@@ -182,6 +183,7 @@ void send_string_with_delay(const char *str, uint8_t interval) {
         // interval
         {
             uint8_t ms = interval;
+            if (ms) flush_keyboard_report_batch();
             while (ms--) wait_ms(1);
         }
     }
@@ -214,6 +216,7 @@ void send_string_with_delay_P(const char *str, uint8_t interval) {
                     ms += keycode - '0';
                     keycode = pgm_read_byte(++str);
                 }
+                flush_keyboard_report_batch();
                 while (ms--) wait_ms(1);
             }
         } else {
@@ -223,6 +226,7 @@ void send_string_with_delay_P(const char *str, uint8_t interval) {
         // interval
         {
             uint8_t ms = interval;
+            if (ms) flush_keyboard_report_batch();
             while (ms--) wait_ms(1);
         }
     }
@@ -21,6 +21,12 @@ enum serial_transaction_id {
     I2C_EXECUTE_CALLBACK,
 #endif  // USE_I2C
 
+#ifdef SPLIT_TRANSPORT_FRAMED
+    EXCHANGE_FRAME_EMPTY,
+    EXCHANGE_FRAME_SHORT,
+    EXCHANGE_FRAME_FULL,
+#endif  // SPLIT_TRANSPORT_FRAMED
+
     GET_SLAVE_MATRIX_CHECKSUM,
     GET_SLAVE_MATRIX_DATA,
 
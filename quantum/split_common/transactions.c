@@ -25,6 +25,7 @@
 #include "transport.h"
 #include "split_util.h"
 #include "transaction_id_define.h"
+#include "latency_profile.h"
 
 #define SYNC_TIMER_OFFSET 2
 
@@ -42,8 +43,17 @@
     { &dummy, 0, 0, sizeof_member(split_shared_memory_t, member), offsetof(split_shared_memory_t, member), cb }
 #define trans_target2initiator_initializer(member) trans_target2initiator_initializer_cb(member, NULL)
 
-#define transport_write(id, data, length) transport_execute_transaction(id, data, length, NULL, 0)
-#define transport_read(id, data, length) transport_execute_transaction(id, NULL, 0, data, length)
+static bool transaction_execute(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length);
+
+#ifdef SPLIT_TRANSPORT_FRAMED
+static bool frame_transport_write(int8_t id, const void *data, size_t length);
+static bool frame_transport_read(int8_t id, void *data, size_t length);
+#    define transport_write(id, data, length) frame_transport_write(id, data, length)
+#    define transport_read(id, data, length) frame_transport_read(id, data, length)
+#else  // SPLIT_TRANSPORT_FRAMED
+#    define transport_write(id, data, length) transaction_execute(id, data, length, NULL, 0)
+#    define transport_read(id, data, length) transaction_execute(id, NULL, 0, data, length)
+#endif  // SPLIT_TRANSPORT_FRAMED
 
 #if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 // Forward-declare the RPC callback handlers
@@ -54,6 +64,53 @@ void slave_rpc_exec_callback(uint8_t initiator2target_buffer_size, const void *i
 ////////////////////////////////////////////////////
 // Helpers
 
+static uint16_t transaction_bytes = 0;  // running total of bytes transferred, used for the scheduler's budget
+
+#ifdef SPLIT_TRANSACTION_STATS
+static split_transaction_stats_t transaction_stats[NUM_TOTAL_TRANSACTIONS];
+
+const split_transaction_stats_t *split_transaction_get_stats(int8_t transaction_id) {
+    if (transaction_id < 0 || transaction_id >= NUM_TOTAL_TRANSACTIONS) {
+        return NULL;
+    }
+    return &transaction_stats[transaction_id];
+}
+
+void split_transaction_reset_stats(void) { memset(transaction_stats, 0, sizeof(transaction_stats)); }
+#endif  // SPLIT_TRANSACTION_STATS
+
+static inline void transaction_account(int8_t id, uint16_t initiator2target_length, uint16_t target2initiator_length) {
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    uint16_t                  bytes = (trans->initiator2target_buffer_size < initiator2target_length ? trans->initiator2target_buffer_size : initiator2target_length) + (trans->target2initiator_buffer_size < target2initiator_length ? trans->target2initiator_buffer_size : target2initiator_length);
+    transaction_bytes += bytes;
+#ifdef SPLIT_TRANSACTION_STATS
+    transaction_stats[id].bytes += bytes;
+#endif  // SPLIT_TRANSACTION_STATS
+}
+
+static bool transaction_execute(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+#if defined(SPLIT_TRANSACTION_STATS) && defined(LATENCY_PROFILE_ENABLE)
+    uint32_t start_us = latency_profile_read_us();
+#endif
+    bool okay = transport_execute_transaction(id, initiator2target_buf, initiator2target_length, target2initiator_buf, target2initiator_length);
+    transaction_account(id, initiator2target_length, target2initiator_length);
+#ifdef SPLIT_TRANSACTION_STATS
+    split_transaction_stats_t *stats = &transaction_stats[id];
+    stats->count++;
+    if (!okay) {
+        stats->failures++;
+    }
+#    ifdef LATENCY_PROFILE_ENABLE
+    uint32_t duration_us = latency_profile_read_us() - start_us;
+    stats->last_us       = duration_us > UINT16_MAX ? UINT16_MAX : duration_us;
+    if (stats->last_us > stats->max_us) {
+        stats->max_us = stats->last_us;
+    }
+#    endif  // LATENCY_PROFILE_ENABLE
+#endif      // SPLIT_TRANSACTION_STATS
+    return okay;
+}
+
 static bool transaction_handler_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[], const char *prefix, bool (*handler)(matrix_row_t master_matrix[], matrix_row_t slave_matrix[])) {
     int num_retries = is_transport_connected() ? 10 : 1;
     for (int iter = 1; iter <= num_retries; ++iter) {
@@ -111,6 +168,196 @@ inline static bool send_if_data_mismatch(int8_t trans_id, uint32_t *last_update,
     return send_if_condition(trans_id, last_update, (memcmp(source, equiv_shmem, length) != 0), source, length);
 }
 
+////////////////////////////////////////////////////
+// Frames
+
+#ifdef SPLIT_TRANSPORT_FRAMED
+
+#    ifndef SPLIT_FRAME_SHORT_SIZE
+#        define SPLIT_FRAME_SHORT_SIZE 16
+#    endif  // SPLIT_FRAME_SHORT_SIZE
+
+_Static_assert(offsetof(split_frame_m2s_t, payload) + SPLIT_MASTER_STATE_SIZE <= UINT8_MAX, "Master-owned split state too large for SPLIT_TRANSPORT_FRAMED");
+
+// Handlers write into and read from the shared memory while a frame is being assembled, rather than executing transactions
+static bool    frame_staging   = false;
+static bool    frame_need_full = true;
+static bool    frame_synced    = false;                       // slave side: a full frame has been applied
+static uint8_t frame_acked[SPLIT_MASTER_STATE_SIZE];          // master-owned state as last acknowledged by the slave
+static uint8_t frame_forced[SPLIT_MASTER_STATE_BITMAP_SIZE];  // bytes to send even if unchanged
+
+static inline uint8_t *frame_master_state(void) { return split_shmem_offset_ptr(SPLIT_SLAVE_STATE_END); }
+
+static void frame_force(uint16_t offset, uint8_t length) {
+    for (uint16_t i = offset - SPLIT_SLAVE_STATE_END; i < offset - SPLIT_SLAVE_STATE_END + length; ++i) {
+        frame_forced[i / 8] |= 1 << (i % 8);
+    }
+}
+
+static bool frame_transport_write(int8_t id, const void *data, size_t length) {
+    if (!frame_staging) {
+        return transaction_execute(id, data, length, NULL, 0);
+    }
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    size_t                    len   = trans->initiator2target_buffer_size < length ? trans->initiator2target_buffer_size : length;
+    memcpy(split_trans_initiator2target_buffer(trans), data, len);
+    // Staged data ends up in the frame, so charge it against the scheduler's budget all the same
+    transaction_account(id, len, 0);
+#    if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    // The slave clears the change flags once it has applied the update, so the whole block has to go every time
+    if (id == PUT_RGBLIGHT) {
+        frame_force(trans->initiator2target_offset, len);
+    }
+#    endif  // defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    return true;
+}
+
+static bool frame_transport_read(int8_t id, void *data, size_t length) {
+    if (!frame_staging) {
+        return transaction_execute(id, NULL, 0, data, length);
+    }
+    split_transaction_desc_t *trans = &split_transaction_table[id];
+    size_t                    len   = trans->target2initiator_buffer_size < length ? trans->target2initiator_buffer_size : length;
+    memcpy(data, split_trans_target2initiator_buffer(trans), len);
+    return true;
+}
+
+// Encodes the master-owned state into a frame, as a delta against the last acknowledged state unless a full frame is
+// needed or would be smaller
+static void frame_encode(split_frame_m2s_t *frame, bool full) {
+    const uint8_t *state = frame_master_state();
+    if (!full) {
+        uint8_t *bitmap = frame->payload;
+        uint8_t *values = frame->payload + SPLIT_MASTER_STATE_BITMAP_SIZE;
+        uint8_t  count  = 0;
+        memset(bitmap, 0, SPLIT_MASTER_STATE_BITMAP_SIZE);
+        for (uint8_t i = 0; i < SPLIT_MASTER_STATE_SIZE; ++i) {
+            if (state[i] != frame_acked[i] || (frame_forced[i / 8] & (1 << (i % 8)))) {
+                if (SPLIT_MASTER_STATE_BITMAP_SIZE + count >= SPLIT_MASTER_STATE_SIZE) {
+                    full = true;
+                    break;
+                }
+                bitmap[i / 8] |= 1 << (i % 8);
+                values[count++] = state[i];
+            }
+        }
+        if (!full) {
+            frame->flags  = 0;
+            frame->length = count ? SPLIT_MASTER_STATE_BITMAP_SIZE + count : 0;
+        }
+    }
+    if (full) {
+        memcpy(frame->payload, state, SPLIT_MASTER_STATE_SIZE);
+        frame->flags  = SPLIT_FRAME_FULL;
+        frame->length = SPLIT_MASTER_STATE_SIZE;
+    }
+    frame->crc = crc8(&frame->flags, offsetof(split_frame_m2s_t, payload) - offsetof(split_frame_m2s_t, flags) + frame->length);
+}
+
+static bool frame_decode(const split_frame_m2s_t *frame, uint8_t frame_size) {
+    uint8_t payload_size = frame_size - offsetof(split_frame_m2s_t, payload);
+    if (frame->length > payload_size || frame->crc != crc8(&frame->flags, offsetof(split_frame_m2s_t, payload) - offsetof(split_frame_m2s_t, flags) + frame->length)) {
+        return false;
+    }
+
+    uint8_t *state = frame_master_state();
+    if (frame->flags & SPLIT_FRAME_FULL) {
+        if (frame->length != SPLIT_MASTER_STATE_SIZE) {
+            return false;
+        }
+        memcpy(state, frame->payload, SPLIT_MASTER_STATE_SIZE);
+        frame_synced = true;
+    } else if (frame->length > 0) {
+        if (frame->length < SPLIT_MASTER_STATE_BITMAP_SIZE) {
+            return false;
+        }
+        const uint8_t *bitmap = frame->payload;
+        const uint8_t *values = frame->payload + SPLIT_MASTER_STATE_BITMAP_SIZE;
+        const uint8_t *end    = frame->payload + frame->length;
+        for (uint8_t i = 0; i < SPLIT_MASTER_STATE_SIZE && values < end; ++i) {
+            if (bitmap[i / 8] & (1 << (i % 8))) {
+                state[i] = *values++;
+            }
+        }
+    }
+    return true;
+}
+
+// The slave may have applied a frame even if the exchange failed, so keep sending its bytes until one is acknowledged
+static void frame_retry(const split_frame_m2s_t *frame) {
+    if (frame->flags & SPLIT_FRAME_FULL) {
+        frame_need_full = true;
+    } else if (frame->length > 0) {
+        for (uint8_t i = 0; i < SPLIT_MASTER_STATE_BITMAP_SIZE; ++i) {
+            frame_forced[i] |= frame->payload[i];
+        }
+    }
+}
+
+static bool frame_handlers_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    split_frame_m2s_t frame;
+    split_frame_s2m_t response;
+    frame_encode(&frame, frame_need_full);
+
+    // Pick the smallest transaction that fits, as the serial transports always transfer the full buffer size
+    int8_t id = EXCHANGE_FRAME_FULL;
+    if (frame.length == 0) {
+        id = EXCHANGE_FRAME_EMPTY;
+    } else if (frame.length <= SPLIT_FRAME_SHORT_SIZE) {
+        id = EXCHANGE_FRAME_SHORT;
+    }
+    if (!transaction_execute(id, &frame, offsetof(split_frame_m2s_t, payload) + frame.length, &response, sizeof(response))) {
+        frame_retry(&frame);
+        return false;
+    }
+    if (response.crc != crc8(&response.status, sizeof(response) - offsetof(split_frame_s2m_t, status))) {
+        frame_retry(&frame);
+        return false;
+    }
+
+    // Hand the slave-owned state over to the slave matrix and encoder handlers
+    memcpy(split_shmem_offset_ptr(SPLIT_SLAVE_STATE_START), response.payload, SPLIT_SLAVE_STATE_SIZE);
+    frame_need_full = response.status & SPLIT_FRAME_RESYNC;
+    if (!(response.status & SPLIT_FRAME_ACK)) {
+        // The slave couldn't apply the frame, so retry it
+        frame_retry(&frame);
+        return false;
+    }
+    memcpy(frame_acked, frame_master_state(), SPLIT_MASTER_STATE_SIZE);
+    memset(frame_forced, 0, sizeof(frame_forced));
+    return true;
+}
+
+static void slave_frame_callback(uint8_t initiator2target_buffer_size, const void *initiator2target_buffer, uint8_t target2initiator_buffer_size, void *target2initiator_buffer) {
+    // Ignore the buffer args, as some transports pass the wrong target2initiator size
+    split_frame_s2m_t *response = &split_frame_memory->frame_s2m;
+
+    response->status = frame_decode(&split_frame_memory->frame_m2s, initiator2target_buffer_size) ? SPLIT_FRAME_ACK : 0;
+    if (!frame_synced) {
+        response->status |= SPLIT_FRAME_RESYNC;
+    }
+    memcpy(response->payload, split_shmem_offset_ptr(SPLIT_SLAVE_STATE_START), SPLIT_SLAVE_STATE_SIZE);
+    response->crc = crc8(&response->status, sizeof(*response) - offsetof(split_frame_s2m_t, status));
+}
+
+#    define SPLIT_FRAME_SHORT_PAYLOAD_SIZE (SPLIT_FRAME_SHORT_SIZE < SPLIT_MASTER_STATE_SIZE ? SPLIT_FRAME_SHORT_SIZE : SPLIT_MASTER_STATE_SIZE)
+
+#    define trans_frame_initializer(payload_size) \
+        { &dummy, offsetof(split_frame_m2s_t, payload) + (payload_size), offsetof(split_frame_memory_t, frame_m2s), sizeof(split_frame_s2m_t), offsetof(split_frame_memory_t, frame_s2m), slave_frame_callback }
+
+// clang-format off
+#    define TRANSACTIONS_FRAME_REGISTRATIONS \
+    [EXCHANGE_FRAME_EMPTY] = trans_frame_initializer(0), \
+    [EXCHANGE_FRAME_SHORT] = trans_frame_initializer(SPLIT_FRAME_SHORT_PAYLOAD_SIZE), \
+    [EXCHANGE_FRAME_FULL]  = trans_frame_initializer(SPLIT_MASTER_STATE_SIZE),
+// clang-format on
+
+#else  // SPLIT_TRANSPORT_FRAMED
+
+#    define TRANSACTIONS_FRAME_REGISTRATIONS
+
+#endif  // SPLIT_TRANSPORT_FRAMED
+
 ////////////////////////////////////////////////////
 // Slave matrix
 
@@ -590,6 +837,7 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
 #endif  // USE_I2C
 
     // clang-format off
+    TRANSACTIONS_FRAME_REGISTRATIONS
     TRANSACTIONS_SLAVE_MATRIX_REGISTRATIONS
     TRANSACTIONS_MASTER_MATRIX_REGISTRATIONS
     TRANSACTIONS_ENCODERS_REGISTRATIONS
@@ -614,22 +862,123 @@ split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS] = {
 #endif  // defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
 };
 
-bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+////////////////////////////////////////////////////
+// Scheduling
+
+#ifndef SPLIT_TRANSACTION_BUDGET
+// Bytes per cycle shared by the lower priority handlers, 0 runs all of them every cycle
+#    define SPLIT_TRANSACTION_BUDGET 0
+#endif  // SPLIT_TRANSACTION_BUDGET
+
+typedef struct _scheduled_handler_t {
+    const char *prefix;
+    bool (*handler)(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
+} scheduled_handler_t;
+
+// The lower priority handlers, in the order they get to use the budget. The TRANSACTIONS_*_MASTER() macros expand to
+// TRANSACTION_HANDLER_MASTER(), so redefine it while building the table to turn each one into an entry.
+#undef TRANSACTION_HANDLER_MASTER
+#define TRANSACTION_HANDLER_MASTER(prefix) {#prefix, &prefix##_handlers_master},
+// clang-format off
+static const scheduled_handler_t scheduled_handlers[] = {
+    TRANSACTIONS_SYNC_TIMER_MASTER()
+    TRANSACTIONS_LAYER_STATE_MASTER()
+    TRANSACTIONS_LED_STATE_MASTER()
+    TRANSACTIONS_BACKLIGHT_MASTER()
+    TRANSACTIONS_RGBLIGHT_MASTER()
+    TRANSACTIONS_LED_MATRIX_MASTER()
+    TRANSACTIONS_RGB_MATRIX_MASTER()
+    TRANSACTIONS_WPM_MASTER()
+    TRANSACTIONS_OLED_MASTER()
+    TRANSACTIONS_ST7565_MASTER()
+};
+// clang-format on
+#undef TRANSACTION_HANDLER_MASTER
+#define TRANSACTION_HANDLER_MASTER(prefix)                                                                              \
+    do {                                                                                                                \
+        if (!transaction_handler_master(master_matrix, slave_matrix, #prefix, &prefix##_handlers_master)) return false; \
+    } while (0)
+
+#define NUM_SCHEDULED_HANDLERS (sizeof(scheduled_handlers) / sizeof(scheduled_handlers[0]))
+
+static uint8_t  scheduled_cursor  = 0;  // handler that goes first next cycle
+static uint16_t cycle_end_bytes   = 0;  // transaction_bytes at the end of the last cycle
+static uint16_t out_of_cycle_debt = 0;  // bytes transferred between cycles, e.g. by RPCs
+
+// Runs the lower priority handlers round-robin until the budget for this cycle has been used up. A handler can overrun
+// the budget, as its cost is only known once it has run, but it then delays the handlers after it to later cycles.
+static bool transactions_master_scheduled(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    uint16_t budget_start = transaction_bytes - out_of_cycle_debt;
+    uint8_t  n            = 0;
+    for (; n < NUM_SCHEDULED_HANDLERS; ++n) {
+#if SPLIT_TRANSACTION_BUDGET > 0
+        if ((uint16_t)(transaction_bytes - budget_start) >= SPLIT_TRANSACTION_BUDGET) {
+            break;
+        }
+#endif  // SPLIT_TRANSACTION_BUDGET > 0
+        uint8_t index = scheduled_cursor + n;
+        if (index >= NUM_SCHEDULED_HANDLERS) {
+            index -= NUM_SCHEDULED_HANDLERS;
+        }
+        if (!transaction_handler_master(master_matrix, slave_matrix, scheduled_handlers[index].prefix, scheduled_handlers[index].handler)) {
+            // Retry the failed handler first next time round
+            scheduled_cursor = index;
+            return false;
+        }
+    }
+#if SPLIT_TRANSACTION_BUDGET > 0
+    scheduled_cursor += n;
+    if (scheduled_cursor >= NUM_SCHEDULED_HANDLERS) {
+        scheduled_cursor -= NUM_SCHEDULED_HANDLERS;
+    }
+#else
+    (void)budget_start;
+#endif  // SPLIT_TRANSACTION_BUDGET > 0
+    return true;
+}
+
+#ifdef SPLIT_TRANSPORT_FRAMED
+
+static bool transactions_master_stage(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    TRANSACTIONS_MASTER_MATRIX_MASTER();
+    TRANSACTIONS_MODS_MASTER();
+    return transactions_master_scheduled(master_matrix, slave_matrix);
+}
+
+static bool transactions_master_exchange(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    TRANSACTION_HANDLER_MASTER(frame);
+    TRANSACTIONS_SLAVE_MATRIX_MASTER();
+    TRANSACTIONS_ENCODERS_MASTER();
+    return true;
+}
+
+static bool transactions_master_cycle(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    // Stage the master-owned state in the shared memory, swap everything in a single frame, then let the handlers pick
+    // the slave-owned state back out of the shared memory
+    frame_staging = true;
+    bool okay     = transactions_master_stage(master_matrix, slave_matrix) && transactions_master_exchange(master_matrix, slave_matrix);
+    frame_staging = false;
+    return okay;
+}
+
+#else  // SPLIT_TRANSPORT_FRAMED
+
+static bool transactions_master_cycle(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    // Matrix, encoder and mods data goes every cycle, ahead of everything else
     TRANSACTIONS_SLAVE_MATRIX_MASTER();
     TRANSACTIONS_MASTER_MATRIX_MASTER();
     TRANSACTIONS_ENCODERS_MASTER();
-    TRANSACTIONS_SYNC_TIMER_MASTER();
-    TRANSACTIONS_LAYER_STATE_MASTER();
-    TRANSACTIONS_LED_STATE_MASTER();
     TRANSACTIONS_MODS_MASTER();
-    TRANSACTIONS_BACKLIGHT_MASTER();
-    TRANSACTIONS_RGBLIGHT_MASTER();
-    TRANSACTIONS_LED_MATRIX_MASTER();
-    TRANSACTIONS_RGB_MATRIX_MASTER();
-    TRANSACTIONS_WPM_MASTER();
-    TRANSACTIONS_OLED_MASTER();
-    TRANSACTIONS_ST7565_MASTER();
-    return true;
+    return transactions_master_scheduled(master_matrix, slave_matrix);
+}
+
+#endif  // SPLIT_TRANSPORT_FRAMED
+
+bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
+    out_of_cycle_debt = transaction_bytes - cycle_end_bytes;
+    bool okay         = transactions_master_cycle(master_matrix, slave_matrix);
+    cycle_end_bytes   = transaction_bytes;
+    return okay;
 }
 
 void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
@@ -42,6 +42,20 @@ extern split_transaction_desc_t split_transaction_table[NUM_TOTAL_TRANSACTIONS];
 #define split_trans_initiator2target_buffer(trans) (split_shmem_offset_ptr((trans)->initiator2target_offset))
 #define split_trans_target2initiator_buffer(trans) (split_shmem_offset_ptr((trans)->target2initiator_offset))
 
+#ifdef SPLIT_TRANSACTION_STATS
+// Per-transaction counters, covering every attempt including retries
+typedef struct _split_transaction_stats_t {
+    uint32_t count;
+    uint32_t failures;
+    uint32_t bytes;
+    uint16_t last_us;  // duration of the last attempt, only measured with LATENCY_PROFILE_ENABLE
+    uint16_t max_us;
+} split_transaction_stats_t;
+
+const split_transaction_stats_t *split_transaction_get_stats(int8_t transaction_id);
+void                             split_transaction_reset_stats(void);
+#endif  // SPLIT_TRANSACTION_STATS
+
 // returns false if valid data not received from slave
 bool transactions_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
 void transactions_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]);
@@ -36,7 +36,11 @@
 #    include "i2c_slave.h"
 
 // Ensure the I2C buffer has enough space
+#    ifdef SPLIT_TRANSPORT_FRAMED
+_Static_assert(sizeof(split_frame_memory_t) <= I2C_SLAVE_REG_COUNT, "split_frame_memory_t too large for I2C_SLAVE_REG_COUNT");
+#    else
 _Static_assert(sizeof(split_shared_memory_t) <= I2C_SLAVE_REG_COUNT, "split_shared_memory_t too large for I2C_SLAVE_REG_COUNT");
+#    endif
 
 split_shared_memory_t *const split_shmem = (split_shared_memory_t *)i2c_slave_reg;
 
@@ -86,8 +90,13 @@ bool transport_execute_transaction(int8_t id, const void *initiator2target_buf,
 
 #    include "serial.h"
 
+#    ifdef SPLIT_TRANSPORT_FRAMED
+static split_frame_memory_t  shared_memory;
+split_shared_memory_t *const split_shmem = &shared_memory.shmem;
+#    else
 static split_shared_memory_t shared_memory;
 split_shared_memory_t *const split_shmem = &shared_memory;
+#    endif
 
 void transport_master_init(void) { soft_serial_initiator_init(); }
 void transport_slave_init(void) { soft_serial_target_init(); }
@@ -119,16 +119,17 @@ typedef struct _split_shared_memory_t {
     int8_t transaction_id;
 #endif  // USE_I2C
 
+    // Slave-owned state comes first, so that it stays contiguous for SPLIT_TRANSPORT_FRAMED
     split_slave_matrix_sync_t smatrix;
 
-#ifdef SPLIT_TRANSPORT_MIRROR
-    split_master_matrix_sync_t mmatrix;
-#endif  // SPLIT_TRANSPORT_MIRROR
-
 #ifdef ENCODER_ENABLE
     split_slave_encoder_sync_t encoders;
 #endif  // ENCODER_ENABLE
 
+#ifdef SPLIT_TRANSPORT_MIRROR
+    split_master_matrix_sync_t mmatrix;
+#endif  // SPLIT_TRANSPORT_MIRROR
+
 #ifndef DISABLE_SYNC_TIMER
     uint32_t sync_timer;
 #endif  // DISABLE_SYNC_TIMER
@@ -181,3 +182,53 @@ typedef struct _split_shared_memory_t {
 } split_shared_memory_t;
 
 extern split_shared_memory_t *const split_shmem;
+
+#ifdef SPLIT_TRANSPORT_FRAMED
+#    include <stddef.h>
+
+// Slave-owned state: the slave matrix and encoder state
+#    define SPLIT_SLAVE_STATE_START offsetof(split_shared_memory_t, smatrix)
+#    ifdef ENCODER_ENABLE
+#        define SPLIT_SLAVE_STATE_END (offsetof(split_shared_memory_t, encoders) + sizeof(split_slave_encoder_sync_t))
+#    else
+#        define SPLIT_SLAVE_STATE_END (offsetof(split_shared_memory_t, smatrix) + sizeof(split_slave_matrix_sync_t))
+#    endif
+#    define SPLIT_SLAVE_STATE_SIZE (SPLIT_SLAVE_STATE_END - SPLIT_SLAVE_STATE_START)
+
+// Master-owned state: everything after the slave-owned state, up to the RPC buffers
+#    if defined(SPLIT_TRANSACTION_IDS_KB) || defined(SPLIT_TRANSACTION_IDS_USER)
+#        define SPLIT_MASTER_STATE_END offsetof(split_shared_memory_t, rpc_info)
+#    else
+#        define SPLIT_MASTER_STATE_END sizeof(split_shared_memory_t)
+#    endif
+#    define SPLIT_MASTER_STATE_SIZE (SPLIT_MASTER_STATE_END - SPLIT_SLAVE_STATE_END)
+#    define SPLIT_MASTER_STATE_BITMAP_SIZE ((SPLIT_MASTER_STATE_SIZE + 7) / 8)
+
+#    define SPLIT_FRAME_FULL 0x01    // payload is the whole master-owned state
+#    define SPLIT_FRAME_ACK 0x01     // the last master frame was applied
+#    define SPLIT_FRAME_RESYNC 0x02  // the slave has not received a full frame since it started
+
+// Master to slave: the master-owned state, either whole or as a bitmap of changed bytes followed by their values
+typedef struct _split_frame_m2s_t {
+    uint8_t crc;  // crc8 of everything after it, up to the end of the used payload
+    uint8_t flags;
+    uint8_t length;
+    uint8_t payload[SPLIT_MASTER_STATE_SIZE];
+} split_frame_m2s_t;
+
+// Slave to master: the slave-owned state, always whole
+typedef struct _split_frame_s2m_t {
+    uint8_t crc;  // crc8 of everything after it
+    uint8_t status;
+    uint8_t payload[SPLIT_SLAVE_STATE_SIZE];
+} split_frame_s2m_t;
+
+// The frame buffers live just past the shared memory, so that they are addressable through split_shmem offsets
+typedef struct _split_frame_memory_t {
+    split_shared_memory_t shmem;
+    split_frame_m2s_t     frame_m2s;
+    split_frame_s2m_t     frame_s2m;
+} split_frame_memory_t;
+
+#    define split_frame_memory ((split_frame_memory_t *)split_shmem)
+#endif  // SPLIT_TRANSPORT_FRAMED
@@ -46,6 +46,7 @@
 #include "dynamic_keymap.h"
 #include "eeprom.h"
 #include "version.h"  // for QMK_BUILDDATE used in EEPROM magic
+#include "latency_profile.h"
 #include "via_ensure_keycode.h"
 
 // Forward declare some helpers.
@@ -188,6 +189,153 @@ __attribute__((weak)) void raw_hid_receive_kb(uint8_t *data, uint8_t length) {
     *command_id         = id_unhandled;
 }
 
+#ifdef VIA_BULK_TRANSFER_ENABLE
+// Bulk transfers move a whole keymap or macro buffer with one request per window of
+// data reports, rather than one request per 28 bytes.
+//
+// id_bulk_transfer_query: [id]
+//     Replies [id, VIA_BULK_TRANSFER_VERSION, payload_size, default_window, target_count].
+//     Firmware without bulk transfers replies id_unhandled, so hosts fall back to
+//     id_dynamic_keymap_get_buffer and friends.
+// id_bulk_transfer_begin: [id, target, write, offset_hi, offset_lo, length_hi, length_lo, window]
+//     Replies [id, status, payload_size, window].
+// id_bulk_transfer_data:  [id, seq, payload...]
+//     Each data report carries payload_size bytes (the report size less the 2 byte header),
+//     the last one possibly fewer. For writes, only the last report of each window is
+//     replied to, with [id, status, seq] or [id, id_bulk_status_done, crc_hi, crc_lo].
+// id_bulk_transfer_ack:   [id]
+//     Reads only, requests the next window of data reports, which are sent ahead of the
+//     reply [id, status, seq], or [id, id_bulk_status_done, crc_hi, crc_lo] once all data
+//     has been sent.
+//
+// The CRC is CRC-16/CCITT-FALSE over the whole transferred range.
+#    define VIA_BULK_TRANSFER_VERSION 0x01
+
+#    ifndef VIA_BULK_TRANSFER_DEFAULT_WINDOW
+#        define VIA_BULK_TRANSFER_DEFAULT_WINDOW 8
+#    endif
+
+typedef struct {
+    bool     active;
+    bool     write;
+    uint8_t  target;
+    uint8_t  window;
+    uint8_t  seq;
+    uint16_t offset;
+    uint16_t remaining;
+    uint16_t crc;
+} via_bulk_transfer_t;
+
+static via_bulk_transfer_t via_bulk;
+
+static uint16_t via_bulk_crc_update(uint16_t crc, const uint8_t *data, uint8_t size) {
+    while (size--) {
+        crc ^= (uint16_t)*data++ << 8;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t via_bulk_target_size(uint8_t target) {
+    switch (target) {
+        case id_bulk_target_keymap:
+            return dynamic_keymap_get_layer_count() * MATRIX_ROWS * MATRIX_COLS * 2;
+        case id_bulk_target_macro:
+            return dynamic_keymap_macro_get_buffer_size();
+        default:
+            return 0;
+    }
+}
+
+// Moves the next chunk between the target buffer and data, returns the chunk size
+static uint8_t via_bulk_transfer_chunk(uint8_t *data, uint8_t payload_size) {
+    uint8_t size = via_bulk.remaining < payload_size ? via_bulk.remaining : payload_size;
+    if (via_bulk.target == id_bulk_target_keymap) {
+        via_bulk.write ? dynamic_keymap_set_buffer(via_bulk.offset, size, data) : dynamic_keymap_get_buffer(via_bulk.offset, size, data);
+    } else {
+        via_bulk.write ? dynamic_keymap_macro_set_buffer(via_bulk.offset, size, data) : dynamic_keymap_macro_get_buffer(via_bulk.offset, size, data);
+    }
+    via_bulk.crc = via_bulk_crc_update(via_bulk.crc, data, size);
+    via_bulk.offset += size;
+    via_bulk.remaining -= size;
+    return size;
+}
+
+// Fills in the status of a window reply
+static void via_bulk_transfer_status(uint8_t *command_data) {
+    if (via_bulk.remaining == 0) {
+        command_data[0]  = id_bulk_status_done;
+        command_data[1]  = via_bulk.crc >> 8;
+        command_data[2]  = via_bulk.crc & 0xFF;
+        via_bulk.active = false;
+    } else {
+        command_data[0] = id_bulk_status_ok;
+        command_data[1] = via_bulk.seq;
+    }
+}
+
+static void via_bulk_transfer_send_window(uint8_t length) {
+    uint8_t report[length];
+    for (uint8_t i = 0; i < via_bulk.window && via_bulk.remaining > 0; i++) {
+        memset(report, 0, length);
+        report[0] = id_bulk_transfer_data;
+        report[1] = via_bulk.seq++;
+        via_bulk_transfer_chunk(&report[2], length - 2);
+        raw_hid_send(report, length);
+    }
+}
+
+static void via_bulk_transfer_begin(uint8_t *command_data, uint8_t length) {
+    uint8_t  target      = command_data[0];
+    uint16_t offset      = (command_data[2] << 8) | command_data[3];
+    uint16_t size        = (command_data[4] << 8) | command_data[5];
+    uint16_t target_size = via_bulk_target_size(target);
+
+    via_bulk.active = false;
+    if (size == 0 || offset >= target_size || size > target_size - offset) {
+        command_data[0] = id_bulk_status_invalid;
+        return;
+    }
+
+    via_bulk.active    = true;
+    via_bulk.write     = command_data[1] != 0;
+    via_bulk.target    = target;
+    via_bulk.window    = command_data[6] ? command_data[6] : VIA_BULK_TRANSFER_DEFAULT_WINDOW;
+    via_bulk.seq       = 0;
+    via_bulk.offset    = offset;
+    via_bulk.remaining = size;
+    via_bulk.crc       = 0xFFFF;
+
+    command_data[0] = id_bulk_status_ok;
+    command_data[1] = length - 2;
+    command_data[2] = via_bulk.window;
+}
+
+// Returns false if no reply should be sent for this report
+static bool via_bulk_transfer_receive(uint8_t *command_data, uint8_t length) {
+    if (!via_bulk.active || !via_bulk.write) {
+        command_data[0] = id_bulk_status_invalid;
+        return true;
+    }
+    if (command_data[0] != via_bulk.seq) {
+        command_data[0] = id_bulk_status_seq;
+        command_data[1] = via_bulk.seq;
+        via_bulk.active = false;
+        return true;
+    }
+
+    via_bulk_transfer_chunk(&command_data[1], length - 2);
+    via_bulk.seq++;
+    if (via_bulk.remaining > 0 && via_bulk.seq % via_bulk.window != 0) {
+        return false;
+    }
+    via_bulk_transfer_status(command_data);
+    return true;
+}
+#endif
+
 // VIA handles received HID messages first, and will route to
 // raw_hid_receive_kb() for command IDs that are not handled here.
 // This gives the keyboard code level the ability to handle the command
@@ -241,6 +389,12 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
 #endif
                     break;
                 }
+#ifdef LATENCY_PROFILE_ENABLE
+                case id_latency_profile: {
+                    latency_profile_get_raw(&command_data[1], length - 2);
+                    break;
+                }
+#endif
                 default: {
                     raw_hid_receive_kb(data, length);
                     break;
@@ -255,6 +409,12 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
                     via_set_layout_options(value);
                     break;
                 }
+#ifdef LATENCY_PROFILE_ENABLE
+                case id_latency_profile: {
+                    latency_profile_reset();
+                    break;
+                }
+#endif
                 default: {
                     raw_hid_receive_kb(data, length);
                     break;
@@ -373,6 +533,34 @@ void raw_hid_receive(uint8_t *data, uint8_t length) {
             dynamic_keymap_set_buffer(offset, size, &command_data[3]);
             break;
         }
+#ifdef VIA_BULK_TRANSFER_ENABLE
+        case id_bulk_transfer_query: {
+            command_data[0] = VIA_BULK_TRANSFER_VERSION;
+            command_data[1] = length - 2;
+            command_data[2] = VIA_BULK_TRANSFER_DEFAULT_WINDOW;
+            command_data[3] = id_bulk_target_count;
+            break;
+        }
+        case id_bulk_transfer_begin: {
+            via_bulk_transfer_begin(command_data, length);
+            break;
+        }
+        case id_bulk_transfer_ack: {
+            if (via_bulk.active && !via_bulk.write) {
+                via_bulk_transfer_send_window(length);
+                via_bulk_transfer_status(command_data);
+            } else {
+                command_data[0] = id_bulk_status_invalid;
+            }
+            break;
+        }
+        case id_bulk_transfer_data: {
+            if (!via_bulk_transfer_receive(command_data, length)) {
+                return;
+            }
+            break;
+        }
+#endif
         default: {
             // The command ID is not known
             // Return the unhandled state
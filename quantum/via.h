@@ -78,13 +78,34 @@ enum via_command_id {
     id_dynamic_keymap_get_layer_count       = 0x11,
     id_dynamic_keymap_get_buffer            = 0x12,
     id_dynamic_keymap_set_buffer            = 0x13,
+    // Not part of the VIA protocol, kept clear of the ids it assigns in sequence
+    id_bulk_transfer_query                  = 0xE0,
+    id_bulk_transfer_begin                  = 0xE1,
+    id_bulk_transfer_ack                    = 0xE2,
+    id_bulk_transfer_data                   = 0xE3,
     id_unhandled                            = 0xFF,
 };
 
+// Targets and status codes of the bulk transfer commands, see raw_hid_receive()
+enum via_bulk_target {
+    id_bulk_target_keymap = 0x00,
+    id_bulk_target_macro  = 0x01,
+    id_bulk_target_count,
+};
+
+enum via_bulk_status {
+    id_bulk_status_ok      = 0x00,  // window complete, more data to follow
+    id_bulk_status_done    = 0x01,  // transfer complete, CRC follows
+    id_bulk_status_invalid = 0x02,  // bad target or range, or no transfer in progress
+    id_bulk_status_seq     = 0x03,  // data report out of sequence, transfer aborted
+};
+
 enum via_keyboard_value_id {
     id_uptime              = 0x01,  //
     id_layout_options      = 0x02,
-    id_switch_matrix_state = 0x03
+    id_switch_matrix_state = 0x03,
+    // Not part of the VIA protocol, kept clear of the ids it assigns in sequence
+    id_latency_profile     = 0xE0,
 };
 
 enum via_lighting_value {
@@ -200,6 +200,10 @@ void protocol_pre_task(void) {
 #    endif /* MOUSEKEY_ENABLE */
     }
 #endif
+
+#ifdef USB_SOF_SCHEDULING
+    usb_sof_schedule_wait();
+#endif
 }
 
 void protocol_post_task(void) {
@@ -468,6 +468,215 @@ void usb_event_queue_task(void) {
     }
 }
 
+/* ---------------------------------------------------------
+ *                    HID report queues
+ * ---------------------------------------------------------
+ */
+
+/* Reports for the keyboard and shared endpoints are queued rather than
+ * waiting for the previous IN transfer to complete. Each queue is drained
+ * from the endpoint's IN callback, so sending never blocks the main loop
+ * unless a queue overflows with reports that can't be coalesced. */
+
+#ifndef USB_REPORT_QUEUE_SIZE
+#    define USB_REPORT_QUEUE_SIZE 4
+#endif
+
+typedef struct {
+    uint8_t size;
+    bool    coalesce; /* false for reports carrying relative values, such as mouse movement */
+    uint8_t data[sizeof(report_keyboard_t)];
+} queued_report_t;
+
+typedef struct {
+    usbep_t            ep;
+    bool               report_ids; /* reports start with their report ID, as on the shared endpoint */
+    uint8_t            head;
+    uint8_t            count;
+    queued_report_t    reports[USB_REPORT_QUEUE_SIZE];
+    queued_report_t    last;       /* newest report, as the host will eventually see it */
+    queued_report_t    in_flight;  /* buffer owned by the driver while transmitting */
+    thread_reference_t waiting;    /* thread waiting for space after an overflow */
+} report_queue_t;
+
+#ifndef KEYBOARD_SHARED_EP
+static report_queue_t keyboard_report_queue = {.ep = KEYBOARD_IN_EPNUM};
+#endif
+#ifdef SHARED_EP_ENABLE
+static report_queue_t shared_report_queue = {.ep = SHARED_IN_EPNUM, .report_ids = true};
+#endif
+
+static inline queued_report_t *report_queue_tail(report_queue_t *queue) { return &queue->reports[(queue->head + queue->count - 1) % USB_REPORT_QUEUE_SIZE]; }
+
+/* Starts transmitting the oldest queued report, if the endpoint is free
+ * must be called from a locked state */
+static void report_queue_kick_i(report_queue_t *queue) {
+    if (queue->count == 0 || usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE || usbGetTransmitStatusI(&USB_DRIVER, queue->ep)) {
+        return;
+    }
+
+    queue->in_flight = queue->reports[queue->head];
+    queue->head      = (queue->head + 1) % USB_REPORT_QUEUE_SIZE;
+    queue->count--;
+    usbStartTransmitI(&USB_DRIVER, queue->ep, queue->in_flight.data, queue->in_flight.size);
+    osalThreadResumeI(&queue->waiting, MSG_OK);
+}
+
+/* The tail report can be replaced by the new one if every byte the tail
+ * changed stays changed, so the host doesn't miss any press or release.
+ * Reports with different IDs describe different devices, so never replace
+ * each other, even if they happen to be the same size */
+static bool report_queue_can_coalesce(const report_queue_t *queue, const queued_report_t *prev, const queued_report_t *tail, const uint8_t *data, uint8_t size) {
+    if (!tail->coalesce || prev->size != tail->size || tail->size != size) {
+        return false;
+    }
+    if (queue->report_ids && (data[0] != tail->data[0] || prev->data[0] != tail->data[0])) {
+        return false;
+    }
+    for (uint8_t i = 0; i < size; i++) {
+        if (prev->data[i] != tail->data[i] && tail->data[i] != data[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Queues a report for transmission
+ * not callable from ISR or locked state */
+static void report_queue_push(report_queue_t *queue, const uint8_t *data, uint8_t size, bool coalesce) {
+    osalSysLock();
+    while (true) {
+        if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
+            break;
+        }
+
+        /* nothing to do if the host will already end up with this report */
+        if (coalesce && queue->last.coalesce && queue->last.size == size && memcmp(queue->last.data, data, size) == 0) {
+            break;
+        }
+
+        if (queue->count < USB_REPORT_QUEUE_SIZE) {
+            queued_report_t *slot = &queue->reports[(queue->head + queue->count) % USB_REPORT_QUEUE_SIZE];
+            slot->size            = size;
+            slot->coalesce        = coalesce;
+            memcpy(slot->data, data, size);
+            queue->count++;
+            queue->last = *slot;
+            report_queue_kick_i(queue);
+            break;
+        }
+
+        const queued_report_t *prev = queue->count > 1 ? &queue->reports[(queue->head + queue->count - 2) % USB_REPORT_QUEUE_SIZE] : &queue->in_flight;
+        queued_report_t *      tail = report_queue_tail(queue);
+        if (coalesce && report_queue_can_coalesce(queue, prev, tail, data, size)) {
+            memcpy(tail->data, data, size);
+            queue->last = *tail;
+            break;
+        }
+
+        /* queue is full of reports the host needs to see, wait for one to go out */
+        if (osalThreadSuspendTimeoutS(&queue->waiting, TIME_MS2I(10)) != MSG_OK) {
+            break;
+        }
+    }
+    osalSysUnlock();
+}
+
+/* Drops anything queued, e.g. after a bus reset
+ * must be called from a locked state */
+static void report_queue_reset_i(report_queue_t *queue) {
+    queue->head      = 0;
+    queue->count     = 0;
+    queue->last.size = 0;
+    osalThreadResumeI(&queue->waiting, MSG_RESET);
+}
+
+static void report_queues_reset_i(void) {
+#ifndef KEYBOARD_SHARED_EP
+    report_queue_reset_i(&keyboard_report_queue);
+#endif
+#ifdef SHARED_EP_ENABLE
+    report_queue_reset_i(&shared_report_queue);
+#endif
+}
+
+/* ---------------------------------------------------------
+ *                    SOF scheduling
+ * ---------------------------------------------------------
+ */
+
+/* With USB_SOF_SCHEDULING the main loop is paced by Start Of Frame
+ * interrupts instead of free-running. The frame in which the host polls
+ * the keyboard endpoint is learnt from the IN callbacks, and each pass
+ * starts USB_SOF_SCAN_LEAD_US before that frame begins, so the report
+ * built from a fresh matrix scan is already queued when the poll comes. */
+
+#ifdef USB_SOF_SCHEDULING
+#    ifndef USB_SOF_SCAN_LEAD_US
+#        define USB_SOF_SCAN_LEAD_US 1000
+#    endif
+
+#    ifdef KEYBOARD_SHARED_EP
+#        define SOF_POLL_INTERVAL USB_SHARED_POLLING_INTERVAL_MS
+#    else
+#        define SOF_POLL_INTERVAL USB_KEYBOARD_POLLING_INTERVAL_MS
+#    endif
+
+static uint8_t            sof_phase; /* frames since the last keyboard poll, modulo the polling interval */
+static bool               sof_poll_known;
+static thread_reference_t sof_waiting;
+
+/* Must be called from a locked state */
+static void sof_schedule_reset_i(void) {
+    sof_phase      = 0;
+    sof_poll_known = false;
+    osalThreadResumeI(&sof_waiting, MSG_RESET);
+}
+
+/* Records that the host polled the keyboard endpoint in the current frame
+ * must be called from a locked state */
+static void sof_schedule_poll_i(void) {
+    sof_phase      = 0;
+    sof_poll_known = true;
+}
+
+/* Called from the SOF interrupt in a locked state: wakes the main loop
+ * when the next frame is one the keyboard endpoint gets polled in. Until
+ * the phase is known it is woken every frame. */
+static void sof_schedule_frame_i(void) {
+    if (++sof_phase >= SOF_POLL_INTERVAL) {
+        sof_phase = 0;
+    }
+    if (!sof_poll_known || sof_phase == SOF_POLL_INTERVAL - 1) {
+        osalThreadResumeI(&sof_waiting, MSG_OK);
+    }
+}
+
+/** \brief Waits for the next scheduled scan slot
+ *
+ * Returns straight away if the bus is not active, and gives up after a
+ * polling interval's worth of missing SOFs so the main loop never stalls.
+ */
+void usb_sof_schedule_wait(void) {
+    osalSysLock();
+    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
+        osalSysUnlock();
+        return;
+    }
+    msg_t msg = osalThreadSuspendTimeoutS(&sof_waiting, TIME_MS2I(SOF_POLL_INTERVAL + 1));
+    osalSysUnlock();
+
+#    if USB_SOF_SCAN_LEAD_US < 1000
+    /* Woken at the start of the frame before the poll, move up to the lead time */
+    if (msg == MSG_OK) {
+        chThdSleepMicroseconds(1000 - USB_SOF_SCAN_LEAD_US);
+    }
+#    else
+    (void)msg;
+#    endif
+}
+#endif
+
 /* Handles the USB driver global events
  * TODO: maybe disable some things when connection is lost? */
 static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
@@ -477,6 +686,10 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
 
         case USB_EVENT_CONFIGURED:
             osalSysLockFromISR();
+            report_queues_reset_i();
+#ifdef USB_SOF_SCHEDULING
+            sof_schedule_reset_i();
+#endif
             /* Enable the endpoints specified into the configuration. */
 #ifndef KEYBOARD_SHARED_EP
             usbInitEndpointI(usbp, KEYBOARD_IN_EPNUM, &kbd_ep_config);
@@ -511,6 +724,12 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
             /* Falls into.*/
         case USB_EVENT_RESET:
             usb_event_queue_enqueue(event);
+            osalSysLockFromISR();
+            report_queues_reset_i();
+#ifdef USB_SOF_SCHEDULING
+            sof_schedule_reset_i();
+#endif
+            osalSysUnlockFromISR();
             for (int i = 0; i < NUM_USB_DRIVERS; i++) {
                 chSysLockFromISR();
                 /* Disconnection event on suspend.*/
@@ -770,16 +989,27 @@ __attribute__((weak)) void restart_usb_driver(USBDriver *usbp) {
 /* keyboard IN callback hander (a kbd report has made it IN) */
 #ifndef KEYBOARD_SHARED_EP
 void kbd_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
     (void)usbp;
     (void)ep;
+
+    osalSysLockFromISR();
+#ifdef USB_SOF_SCHEDULING
+    sof_schedule_poll_i();
+#endif
+    report_queue_kick_i(&keyboard_report_queue);
+    osalSysUnlockFromISR();
 }
 #endif
 
-/* start-of-frame handler
- * TODO: i guess it would be better to re-implement using timers,
- *  so that this is not going to have to be checked every 1ms */
-void kbd_sof_cb(USBDriver *usbp) { (void)usbp; }
+/* start-of-frame handler */
+void kbd_sof_cb(USBDriver *usbp) {
+    (void)usbp;
+#ifdef USB_SOF_SCHEDULING
+    osalSysLockFromISR();
+    sof_schedule_frame_i();
+    osalSysUnlockFromISR();
+#endif
+}
 
 /* Idle requests timer code
  * callback (called from ISR, unlocked state) */
@@ -821,51 +1051,15 @@ static void keyboard_idle_timer_cb(void *arg) {
 /* LED status */
 uint8_t keyboard_leds(void) { return keyboard_led_state; }
 
-/* prepare and start sending a report IN
+/* queue a report for sending IN
  * not callable from ISR or locked state */
 void send_keyboard(report_keyboard_t *report) {
-    osalSysLock();
-    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-        goto unlock;
-    }
-
 #ifdef NKRO_ENABLE
     if (keymap_config.nkro && keyboard_protocol) { /* NKRO protocol */
-        /* need to wait until the previous packet has made it through */
-        /* can rewrite this using the synchronous API, then would wait
-         * until *after* the packet has been transmitted. I think
-         * this is more efficient */
-        /* busy wait, should be short and not very common */
-        if (usbGetTransmitStatusI(&USB_DRIVER, SHARED_IN_EPNUM)) {
-            /* Need to either suspend, or loop and call unlock/lock during
-             * every iteration - otherwise the system will remain locked,
-             * no interrupts served, so USB not going through as well.
-             * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-            osalThreadSuspendS(&(&USB_DRIVER)->epc[SHARED_IN_EPNUM]->in_state->thread);
-
-            /* after osalThreadSuspendS returns USB status might have changed */
-            if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-                goto unlock;
-            }
-        }
-        usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)report, sizeof(struct nkro_report));
+        report_queue_push(&shared_report_queue, (uint8_t *)report, sizeof(struct nkro_report), true);
     } else
 #endif /* NKRO_ENABLE */
     {  /* regular protocol */
-        /* need to wait until the previous packet has made it through */
-        /* busy wait, should be short and not very common */
-        if (usbGetTransmitStatusI(&USB_DRIVER, KEYBOARD_IN_EPNUM)) {
-            /* Need to either suspend, or loop and call unlock/lock during
-             * every iteration - otherwise the system will remain locked,
-             * no interrupts served, so USB not going through as well.
-             * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-            osalThreadSuspendS(&(&USB_DRIVER)->epc[KEYBOARD_IN_EPNUM]->in_state->thread);
-
-            /* after osalThreadSuspendS returns USB status might have changed */
-            if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-                goto unlock;
-            }
-        }
         uint8_t *data, size;
         if (keyboard_protocol) {
             data = (uint8_t *)report;
@@ -874,11 +1068,15 @@ void send_keyboard(report_keyboard_t *report) {
             data = &report->mods;
             size = 8;
         }
-        usbStartTransmitI(&USB_DRIVER, KEYBOARD_IN_EPNUM, data, size);
+#ifdef KEYBOARD_SHARED_EP
+        report_queue_push(&shared_report_queue, data, size, true);
+#else
+        report_queue_push(&keyboard_report_queue, data, size, true);
+#endif
     }
-    keyboard_report_sent = *report;
 
-unlock:
+    osalSysLock();
+    keyboard_report_sent = *report;
     osalSysUnlock();
 }
 
@@ -898,6 +1096,11 @@ void mouse_in_cb(USBDriver *usbp, usbep_t ep) {
 #    endif
 
 void send_mouse(report_mouse_t *report) {
+#    ifdef MOUSE_SHARED_EP
+    /* shares the endpoint with queued reports, so must go through the queue too */
+    _Static_assert(sizeof(report_mouse_t) <= sizeof(report_keyboard_t), "mouse report too large for the report queue");
+    report_queue_push(&shared_report_queue, (uint8_t *)report, sizeof(report_mouse_t), false);
+#    else
     osalSysLock();
     if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
         osalSysUnlock();
@@ -916,6 +1119,7 @@ void send_mouse(report_mouse_t *report) {
     }
     usbStartTransmitI(&USB_DRIVER, MOUSE_IN_EPNUM, (uint8_t *)report, sizeof(report_mouse_t));
     osalSysUnlock();
+#    endif
 }
 
 #else  /* MOUSE_ENABLE */
@@ -929,9 +1133,15 @@ void send_mouse(report_mouse_t *report) { (void)report; }
 #ifdef SHARED_EP_ENABLE
 /* shared IN callback hander */
 void shared_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
     (void)usbp;
     (void)ep;
+
+    osalSysLockFromISR();
+#if defined(USB_SOF_SCHEDULING) && defined(KEYBOARD_SHARED_EP)
+    sof_schedule_poll_i();
+#endif
+    report_queue_kick_i(&shared_report_queue);
+    osalSysUnlockFromISR();
 }
 #endif
 
@@ -942,28 +1152,9 @@ void shared_in_cb(USBDriver *usbp, usbep_t ep) {
 
 #ifdef EXTRAKEY_ENABLE
 static void send_extra(uint8_t report_id, uint16_t data) {
-    osalSysLock();
-    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-        osalSysUnlock();
-        return;
-    }
+    report_extra_t report = {.report_id = report_id, .usage = data};
 
-    if (usbGetTransmitStatusI(&USB_DRIVER, SHARED_IN_EPNUM)) {
-        /* Need to either suspend, or loop and call unlock/lock during
-         * every iteration - otherwise the system will remain locked,
-         * no interrupts served, so USB not going through as well.
-         * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
-        if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[SHARED_IN_EPNUM]->in_state->thread, TIME_MS2I(10)) == MSG_TIMEOUT) {
-            osalSysUnlock();
-            return;
-        }
-    }
-
-    static report_extra_t report;
-    report = (report_extra_t){.report_id = report_id, .usage = data};
-
-    usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)&report, sizeof(report_extra_t));
-    osalSysUnlock();
+    report_queue_push(&shared_report_queue, (uint8_t *)&report, sizeof(report_extra_t), true);
 }
 #endif
 
@@ -982,14 +1173,8 @@ void send_consumer(uint16_t data) {
 void send_digitizer(report_digitizer_t *report) {
 #ifdef DIGITIZER_ENABLE
 #    ifdef DIGITIZER_SHARED_EP
-    osalSysLock();
-    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
-        osalSysUnlock();
-        return;
-    }
-
-    usbStartTransmitI(&USB_DRIVER, DIGITIZER_IN_EPNUM, (uint8_t *)report, sizeof(report_digitizer_t));
-    osalSysUnlock();
+    _Static_assert(sizeof(report_digitizer_t) <= sizeof(report_keyboard_t), "digitizer report too large for the report queue");
+    report_queue_push(&shared_report_queue, (uint8_t *)report, sizeof(report_digitizer_t), true);
 #    else
     chnWrite(&drivers.digitizer_driver.driver, (uint8_t *)report, sizeof(report_digitizer_t));
 #    endif
@@ -48,6 +48,11 @@ void usb_event_queue_init(void);
 /* Task to dequeue and execute any handlers for the USB events on the main thread */
 void usb_event_queue_task(void);
 
+#ifdef USB_SOF_SCHEDULING
+/* Blocks the main loop until just before the host's next keyboard poll */
+void usb_sof_schedule_wait(void);
+#endif
+
 /* ---------------
  * Keyboard header
  * ---------------
@@ -23,6 +23,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "debug.h"
 #include "digitizer.h"
+#include "latency_profile.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -70,7 +71,9 @@ void host_keyboard_send(report_keyboard_t *report) {
         report->report_id = REPORT_ID_KEYBOARD;
 #endif
     }
+    LATENCY_PROFILE_START(send_start);
     (*driver->send_keyboard)(report);
+    LATENCY_PROFILE_STOP(send_start, LATENCY_STAGE_USB_SEND);
 
     if (debug_keyboard) {
         dprint("keyboard_report: ");
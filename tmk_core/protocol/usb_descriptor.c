@@ -126,6 +126,17 @@ const USB_Descriptor_HIDReport_Datatype_t PROGMEM SharedReport[] = {
             HID_RI_REPORT_SIZE(8, 0x01),
             HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_ABSOLUTE),
 
+#    ifdef MOUSE_EXTENDED_REPORT
+            // X/Y position (4 bytes)
+            HID_RI_USAGE_PAGE(8, 0x01),    // Generic Desktop
+            HID_RI_USAGE(8, 0x30),         // X
+            HID_RI_USAGE(8, 0x31),         // Y
+            HID_RI_LOGICAL_MINIMUM(16, -32767),
+            HID_RI_LOGICAL_MAXIMUM(16, 32767),
+            HID_RI_REPORT_COUNT(8, 0x02),
+            HID_RI_REPORT_SIZE(8, 0x10),
+            HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_RELATIVE),
+#    else
             // X/Y position (2 bytes)
             HID_RI_USAGE_PAGE(8, 0x01),    // Generic Desktop
             HID_RI_USAGE(8, 0x30),         // X
@@ -135,6 +146,7 @@ const USB_Descriptor_HIDReport_Datatype_t PROGMEM SharedReport[] = {
             HID_RI_REPORT_COUNT(8, 0x02),
             HID_RI_REPORT_SIZE(8, 0x08),
             HID_RI_INPUT(8, HID_IOF_DATA | HID_IOF_VARIABLE | HID_IOF_RELATIVE),
+#    endif
 
             // Vertical wheel (1 byte)
             HID_RI_USAGE(8, 0x38),         // Wheel
@@ -449,10 +461,6 @@ const USB_Descriptor_Device_t PROGMEM DeviceDescriptor = {
 #    define USB_MAX_POWER_CONSUMPTION 500
 #endif
 
-#ifndef USB_POLLING_INTERVAL_MS
-#    define USB_POLLING_INTERVAL_MS 10
-#endif
-
 /*
  * Configuration descriptors
  */
@@ -505,7 +513,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | KEYBOARD_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = KEYBOARD_EPSIZE,
-        .PollingIntervalMS      = USB_POLLING_INTERVAL_MS
+        .PollingIntervalMS      = USB_KEYBOARD_POLLING_INTERVAL_MS
     },
 #endif
 
@@ -545,7 +553,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | RAW_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = RAW_EPSIZE,
-        .PollingIntervalMS      = 0x01
+        .PollingIntervalMS      = USB_RAW_POLLING_INTERVAL_MS
     },
     .Raw_OUTEndpoint = {
         .Header = {
@@ -555,7 +563,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_OUT | RAW_OUT_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = RAW_EPSIZE,
-        .PollingIntervalMS      = 0x01
+        .PollingIntervalMS      = USB_RAW_POLLING_INTERVAL_MS
     },
 #endif
 
@@ -595,7 +603,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | MOUSE_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = MOUSE_EPSIZE,
-        .PollingIntervalMS      = USB_POLLING_INTERVAL_MS
+        .PollingIntervalMS      = USB_MOUSE_POLLING_INTERVAL_MS
     },
 #endif
 
@@ -640,7 +648,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | SHARED_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = SHARED_EPSIZE,
-        .PollingIntervalMS      = USB_POLLING_INTERVAL_MS
+        .PollingIntervalMS      = USB_SHARED_POLLING_INTERVAL_MS
     },
 #endif
 
@@ -680,7 +688,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | CONSOLE_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = CONSOLE_EPSIZE,
-        .PollingIntervalMS      = 0x01
+        .PollingIntervalMS      = USB_CONSOLE_POLLING_INTERVAL_MS
     },
     .Console_OUTEndpoint = {
         .Header = {
@@ -690,7 +698,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_OUT | CONSOLE_OUT_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = CONSOLE_EPSIZE,
-        .PollingIntervalMS      = 0x01
+        .PollingIntervalMS      = USB_CONSOLE_POLLING_INTERVAL_MS
     },
 #endif
 
@@ -985,7 +993,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | JOYSTICK_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = JOYSTICK_EPSIZE,
-        .PollingIntervalMS      = USB_POLLING_INTERVAL_MS
+        .PollingIntervalMS      = USB_JOYSTICK_POLLING_INTERVAL_MS
     }
 #endif
 
@@ -1025,7 +1033,7 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor = {
         .EndpointAddress        = (ENDPOINT_DIR_IN | DIGITIZER_IN_EPNUM),
         .Attributes             = (EP_TYPE_INTERRUPT | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
         .EndpointSize           = DIGITIZER_EPSIZE,
-        .PollingIntervalMS      = USB_POLLING_INTERVAL_MS
+        .PollingIntervalMS      = USB_DIGITIZER_POLLING_INTERVAL_MS
     },
 #endif
 };
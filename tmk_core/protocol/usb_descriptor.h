@@ -310,4 +310,31 @@ enum usb_endpoints {
 #define JOYSTICK_EPSIZE 8
 #define DIGITIZER_EPSIZE 8
 
+#ifndef USB_POLLING_INTERVAL_MS
+#    define USB_POLLING_INTERVAL_MS 10
+#endif
+
+// Per-endpoint polling intervals, in milliseconds (frames at full speed)
+#ifndef USB_KEYBOARD_POLLING_INTERVAL_MS
+#    define USB_KEYBOARD_POLLING_INTERVAL_MS USB_POLLING_INTERVAL_MS
+#endif
+#ifndef USB_MOUSE_POLLING_INTERVAL_MS
+#    define USB_MOUSE_POLLING_INTERVAL_MS USB_POLLING_INTERVAL_MS
+#endif
+#ifndef USB_SHARED_POLLING_INTERVAL_MS
+#    define USB_SHARED_POLLING_INTERVAL_MS USB_POLLING_INTERVAL_MS
+#endif
+#ifndef USB_JOYSTICK_POLLING_INTERVAL_MS
+#    define USB_JOYSTICK_POLLING_INTERVAL_MS USB_POLLING_INTERVAL_MS
+#endif
+#ifndef USB_DIGITIZER_POLLING_INTERVAL_MS
+#    define USB_DIGITIZER_POLLING_INTERVAL_MS USB_POLLING_INTERVAL_MS
+#endif
+#ifndef USB_RAW_POLLING_INTERVAL_MS
+#    define USB_RAW_POLLING_INTERVAL_MS 1
+#endif
+#ifndef USB_CONSOLE_POLLING_INTERVAL_MS
+#    define USB_CONSOLE_POLLING_INTERVAL_MS 1
+#endif
+
 uint16_t get_usb_descriptor(const uint16_t wValue, const uint16_t wIndex, const void** const DescriptorAddress);
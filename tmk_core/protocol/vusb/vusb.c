@@ -478,6 +478,17 @@ const PROGMEM uchar shared_hid_report[] = {
     0x75, 0x01,  //     Report Size (1)
     0x81, 0x02,  //     Input (Data, Variable, Absolute)
 
+#    ifdef MOUSE_EXTENDED_REPORT
+    // X/Y position (4 bytes)
+    0x05, 0x01,        //     Usage Page (Generic Desktop)
+    0x09, 0x30,        //     Usage (X)
+    0x09, 0x31,        //     Usage (Y)
+    0x16, 0x01, 0x80,  //     Logical Minimum (-32767)
+    0x26, 0xFF, 0x7F,  //     Logical Maximum (32767)
+    0x95, 0x02,        //     Report Count (2)
+    0x75, 0x10,        //     Report Size (16)
+    0x81, 0x06,        //     Input (Data, Variable, Relative)
+#    else
     // X/Y position (2 bytes)
     0x05, 0x01,  //     Usage Page (Generic Desktop)
     0x09, 0x30,  //     Usage (X)
@@ -487,6 +498,7 @@ const PROGMEM uchar shared_hid_report[] = {
     0x95, 0x02,  //     Report Count (2)
     0x75, 0x08,  //     Report Size (8)
     0x81, 0x06,  //     Input (Data, Variable, Relative)
+#    endif
 
     // Vertical wheel (1 byte)
     0x09, 0x38,  //     Usage (Wheel)